@@ -0,0 +1,304 @@
+// Modo por lotes del solucionador: resuelve muchas combinaciones de (misioneros, caníbales, capacidad, algoritmo) repartiéndolas
+// entre todos los núcleos con un pool de hilos que se roban trabajo entre ellos, y junta todos los resultados en una sola
+// salida respetando el orden de entrada
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "solver.h"
+#include "cache.h"
+// Librerías estándar de c++
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <cstdlib>
+
+using namespace std;
+
+// Un problema a resolver dentro del lote
+struct BatchJob
+{
+    int missionaries, cannibals, boat_capacity;
+    SolverAlgorithm algorithm;
+};
+
+// Resultado de resolver un problema del lote
+struct BatchResult
+{
+    bool solved;
+    // Numero de movimientos de la solución (0 si no hay solución, -1 si solo se reviso si tiene solución)
+    long long moves;
+    long long states_expanded;
+    // Tiempo que tardo la resolución en segundos
+    double seconds;
+};
+
+// Cola de trabajos de un hilo, su dueño toma trabajos del frente y los demás hilos le roban del final, cada cola tiene su
+// propio mutex, por lo que los hilos solo compiten entre ellos cuando uno se queda sin trabajo
+struct WorkerQueue
+{
+    mutex lock;
+    deque<size_t> jobs;
+};
+
+// Pool de hilos con robo de trabajo (work stealing), al inicio cada hilo recibe un bloque continuo de trabajos, y cuando
+// termina los suyos le roba la mitad de los pendientes a otro hilo, asi los hilos que reciben problemas fáciles ayudan a
+// los que recibieron problemas grandes y todos terminan casi al mismo tiempo
+struct WorkStealingPool
+{
+    vector<WorkerQueue> queues;
+
+    // Ejecuta task(worker, job) para cada job de 0 a num_jobs - 1 usando num_threads hilos y espera a que todos terminen,
+    // worker es el numero del hilo (de 0 a num_threads - 1) para que cada uno pueda usar sus propios buffers
+    void run(size_t num_jobs, int num_threads, const function<void(int, size_t)> &task)
+    {
+        if (num_threads < 1)
+            num_threads = 1;
+        queues = vector<WorkerQueue>(num_threads);
+
+        // Repartimos los trabajos en bloques continuos, uno por hilo
+        for (int w = 0; w < num_threads; ++w)
+        {
+            size_t first = num_jobs * w / num_threads;
+            size_t last = num_jobs * (w + 1) / num_threads;
+            for (size_t job = first; job < last; ++job)
+                queues[w].jobs.push_back(job);
+        }
+
+        // El hilo principal también trabaja como el hilo 0
+        vector<thread> threads;
+        for (int w = 1; w < num_threads; ++w)
+            threads.push_back(thread(&WorkStealingPool::worker_loop, this, w, cref(task)));
+        worker_loop(0, task);
+
+        for (size_t i = 0; i < threads.size(); ++i)
+            threads[i].join();
+    }
+
+    // Ciclo de cada hilo, toma trabajos de su cola y cuando se vacía intenta robar, como durante el lote no se crean trabajos
+    // nuevos, si ya no hay nada que robar en ninguna cola el hilo termina
+    void worker_loop(int worker, const function<void(int, size_t)> &task)
+    {
+        size_t job;
+        while (pop(worker, job) || steal(worker, job))
+            task(worker, job);
+    }
+
+    // Saca el siguiente trabajo de la cola propia
+    bool pop(int worker, size_t &job)
+    {
+        lock_guard<mutex> guard(queues[worker].lock);
+        if (queues[worker].jobs.empty())
+            return false;
+        job = queues[worker].jobs.front();
+        queues[worker].jobs.pop_front();
+        return true;
+    }
+
+    // Roba la mitad de los trabajos pendientes de otro hilo, devuelve en job uno de ellos para ejecutarlo de inmediato y el
+    // resto los pasa a la cola propia
+    bool steal(int worker, size_t &job)
+    {
+        int num_threads = (int)queues.size();
+        for (int i = 1; i < num_threads; ++i)
+        {
+            int victim = (worker + i) % num_threads;
+            vector<size_t> stolen;
+            {
+                lock_guard<mutex> guard(queues[victim].lock);
+                size_t count = (queues[victim].jobs.size() + 1) / 2;
+                for (size_t k = 0; k < count; ++k)
+                {
+                    stolen.push_back(queues[victim].jobs.back());
+                    queues[victim].jobs.pop_back();
+                }
+            }
+            if (stolen.empty())
+                continue;
+
+            // Los trabajos se robaron del final, por lo que el ultimo robado es el que va primero
+            job = stolen.back();
+            stolen.pop_back();
+            if (!stolen.empty())
+            {
+                lock_guard<mutex> guard(queues[worker].lock);
+                for (size_t k = stolen.size(); k-- > 0;)
+                    queues[worker].jobs.push_back(stolen[k]);
+            }
+            return true;
+        }
+        return false;
+    }
+};
+
+// Resuelve todos los problemas del lote con num_threads hilos, results[i] queda con el resultado de jobs[i], si se da un cache
+// los problemas que ya estén en el no se vuelven a resolver y los nuevos se agregan a el
+inline void run_batch(const vector<BatchJob> &jobs, vector<BatchResult> &results, int num_threads, SolutionCache *cache = nullptr)
+{
+    results.assign(jobs.size(), BatchResult());
+
+    // Cada hilo tiene su propio workspace y su propio vector para el camino, que se reutilizan en todos sus problemas
+    vector<SolverWorkspace> workspaces(max(1, num_threads));
+    vector<vector<State> > paths(max(1, num_threads));
+
+    WorkStealingPool pool;
+    pool.run(jobs.size(), num_threads, [&](int worker, size_t i) {
+        const BatchJob &job = jobs[i];
+        vector<State> &path = paths[worker];
+        path.clear();
+
+        SolveStats stats;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        bool solved, from_cache;
+        if (cache)
+            solved = solve_mc_cached(*cache, job.missionaries, job.cannibals, job.boat_capacity, path, job.algorithm, &stats, &workspaces[worker],
+                                     from_cache);
+        else
+            solved = solve_mc(job.missionaries, job.cannibals, job.boat_capacity, path, job.algorithm, &stats, &workspaces[worker]);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+        // Cada hilo escribe solo en la posición de su trabajo, por lo que no hace falta sincronizar el vector de resultados
+        BatchResult &result = results[i];
+        result.solved = solved;
+        result.moves = solved ? (long long)path.size() - 1 : 0;
+        result.states_expanded = stats.states_expanded;
+        result.seconds = elapsed.count();
+    });
+}
+
+// Solo revisa si cada problema del lote tiene solución con is_solvable, sin buscar los caminos, como cada problema se
+// responde en tiempo constante no hace falta repartirlos entre hilos
+inline void run_batch_solvability(const vector<BatchJob> &jobs, vector<BatchResult> &results)
+{
+    results.assign(jobs.size(), BatchResult());
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        results[i].solved = is_solvable(jobs[i].missionaries, jobs[i].cannibals, jobs[i].boat_capacity);
+        results[i].moves = -1;
+        results[i].states_expanded = 0;
+        results[i].seconds = 0;
+    }
+}
+
+// Escribe los resultados del lote como CSV, una linea por problema en el mismo orden en que se dieron. El algoritmo se escribe
+// con el mismo nombre que acepta parse_algorithm, asi el CSV se puede volver a usar como archivo de problemas
+inline void write_batch_results(ostream &out, const vector<BatchJob> &jobs, const vector<BatchResult> &results)
+{
+    out << "missionaries,cannibals,capacity,algorithm,solvable,moves,states_expanded,seconds\n";
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        out << jobs[i].missionaries << ',' << jobs[i].cannibals << ',' << jobs[i].boat_capacity << ','
+            << algorithm_id(jobs[i].algorithm) << ',' << (results[i].solved ? "yes" : "no") << ',';
+        // Si solo se reviso si tiene solución no sabemos cuantos movimientos son, por lo que la columna queda vacía
+        if (results[i].moves >= 0)
+            out << results[i].moves;
+        out << ',' << results[i].states_expanded << ',' << results[i].seconds << '\n';
+    }
+    out.flush();
+}
+
+// Lee una lista de enteros separados por comas donde cada elemento puede ser un numero ("3"), un rango ("1:100") o un rango
+// con paso ("0:1000:10"), por ejemplo "1:5,10,20:30:5", devuelve false si el texto no tiene ese formato
+inline bool parse_int_list(const string &text, vector<int> &values)
+{
+    stringstream items(text);
+    string item;
+    while (getline(items, item, ','))
+    {
+        int parts[3] = {0, 0, 1};
+        int num_parts = 0;
+        stringstream fields(item);
+        string field;
+        while (getline(fields, field, ':'))
+        {
+            if (num_parts == 3 || !parse_count(field.c_str(), parts[num_parts++]))
+                return false;
+        }
+        if (num_parts == 0)
+            return false;
+        if (num_parts == 1)
+            parts[1] = parts[0];
+        if (parts[1] < parts[0] || parts[2] < 1)
+            return false;
+        for (long long v = parts[0]; v <= parts[1]; v += parts[2])
+            values.push_back((int)v);
+    }
+    return !values.empty();
+}
+
+// Lee una lista de algoritmos separados por comas, por ejemplo "dfs,bfs,bidi"
+inline bool parse_algorithm_list(const string &text, vector<SolverAlgorithm> &algorithms)
+{
+    stringstream items(text);
+    string item;
+    while (getline(items, item, ','))
+    {
+        SolverAlgorithm algorithm;
+        if (!parse_algorithm(item, algorithm))
+            return false;
+        algorithms.push_back(algorithm);
+    }
+    return !algorithms.empty();
+}
+
+// Construye todos los problemas de una malla de valores, recorriendo misioneros, después caníbales, capacidades y algoritmos
+inline void build_batch_grid(const vector<int> &missionaries, const vector<int> &cannibals, const vector<int> &capacities,
+                             const vector<SolverAlgorithm> &algorithms, vector<BatchJob> &jobs)
+{
+    for (size_t m = 0; m < missionaries.size(); ++m)
+        for (size_t c = 0; c < cannibals.size(); ++c)
+            for (size_t k = 0; k < capacities.size(); ++k)
+                for (size_t a = 0; a < algorithms.size(); ++a)
+                {
+                    BatchJob job = {missionaries[m], cannibals[c], capacities[k], algorithms[a]};
+                    jobs.push_back(job);
+                }
+}
+
+// Lee los problemas de un archivo con una linea "misioneros caníbales capacidad [algoritmo]" por problema, las lineas vacías
+// y las que empiezan con # se ignoran, devuelve false (y en line_number la linea con el error) si alguna linea no es valida.
+// Los campos también pueden ir separados por comas y el resto de las columnas se ignora, asi se puede leer el CSV que escribe
+// write_batch_results (su encabezado también se ignora)
+inline bool read_batch_file(istream &in, vector<BatchJob> &jobs, int &line_number)
+{
+    string line;
+    line_number = 0;
+    while (getline(in, line))
+    {
+        line_number++;
+        replace(line.begin(), line.end(), ',', ' ');
+        stringstream fields(line);
+        BatchJob job;
+        if (!(fields >> job.missionaries))
+        {
+            // Linea vacía o comentario
+            fields.clear();
+            string first;
+            if (!(fields >> first) || first[0] == '#' || (line_number == 1 && first == "missionaries"))
+                continue;
+            return false;
+        }
+        if (!(fields >> job.cannibals >> job.boat_capacity))
+            return false;
+
+        job.algorithm = ALGORITHM_DFS;
+        string algorithm;
+        if (fields >> algorithm && !parse_algorithm(algorithm, job.algorithm))
+            return false;
+
+        if (job.missionaries < 0 || job.cannibals < 0 || job.missionaries > (int)State::COUNT_MASK || job.cannibals > (int)State::COUNT_MASK ||
+            job.boat_capacity < 1 || job.boat_capacity > MAX_BOAT_CAPACITY)
+            return false;
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,386 @@
+// Benchmark del solucionador, corre siempre el mismo conjunto de problemas (el clásico 3/3, casos sin solución y mallas
+// grandes con y sin solución) con cada algoritmo y reporta los estados expandidos, estados por segundo, la memoria máxima
+// de la tabla de visitados y el tiempo, en JSON para poder guardarlo y compararlo después contra otra versión del código
+#include "solver.h"
+#include "batch.h"
+// Librerías estándar de c++
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+// Un conjunto fijo de problemas que se mide como una sola unidad
+struct Workload
+{
+    string name;
+    vector<BatchJob> jobs;
+    // Cuantas veces se resuelve todo el conjunto en cada pasada, los problemas pequeños se repiten muchas veces para que
+    // el tiempo sea medible
+    int iterations;
+    // Si se resuelve sin la regla de is_solvable, para medir la búsqueda completa en los problemas sin solución (con la
+    // regla solo se mediría el tiempo de revisarla)
+    bool full_search;
+};
+
+// Resultado de medir un conjunto de problemas con un algoritmo
+struct WorkloadResult
+{
+    string name;
+    SolverAlgorithm algorithm;
+    int problems;
+    int iterations;
+    // Problemas con solución (contados una sola vez, aunque el conjunto se resuelva varias veces)
+    int solved;
+    // Estados expandidos sumando todas las iteraciones
+    long long states_expanded;
+    size_t peak_visited_bytes;
+    size_t peak_search_bytes;
+    // Mediana del tiempo de una pasada (todas las iteraciones del conjunto) en segundos
+    double seconds;
+    // Pasadas que se hicieron en cada medición para llegar al tiempo mínimo
+    long long runs;
+};
+
+// Tiempo mínimo de cada medición, el conjunto se resuelve tantas pasadas como haga falta para llegar a el, asi los conjuntos
+// que tardan décimas de milisegundo no se miden con el ruido del reloj y del sistema
+const double MIN_MEASURE_SECONDS = 0.05;
+
+// Agrega un conjunto de problemas con un solo problema
+void add_single(vector<Workload> &workloads, const string &name, int m, int c, int k, int iterations, bool full_search = false)
+{
+    Workload workload;
+    workload.name = name;
+    workload.iterations = iterations;
+    workload.full_search = full_search;
+    BatchJob job = {m, c, k, ALGORITHM_DFS};
+    workload.jobs.push_back(job);
+    workloads.push_back(workload);
+}
+
+// Agrega un conjunto de problemas formado por todas las combinaciones de misioneros, caníbales y capacidades
+void add_grid(vector<Workload> &workloads, const string &name, int max_m, int max_c, int min_k, int max_k)
+{
+    Workload workload;
+    workload.name = name;
+    workload.iterations = 1;
+    workload.full_search = false;
+    vector<int> missionaries, cannibals, capacities;
+    for (int m = 0; m <= max_m; ++m)
+        missionaries.push_back(m);
+    for (int c = 0; c <= max_c; ++c)
+        cannibals.push_back(c);
+    for (int k = min_k; k <= max_k; ++k)
+        capacities.push_back(k);
+    build_batch_grid(missionaries, cannibals, capacities, vector<SolverAlgorithm>(1, ALGORITHM_DFS), workload.jobs);
+    workloads.push_back(workload);
+}
+
+// Conjuntos de problemas del benchmark, no se deben de cambiar para que los resultados se puedan comparar entre versiones. Los
+// problemas sin solución se resuelven sin la regla de is_solvable, para que sigan midiendo lo que cuesta agotar la búsqueda
+void build_workloads(vector<Workload> &workloads)
+{
+    add_single(workloads, "classic_3_3", 3, 3, 2, 20000);
+    add_single(workloads, "unsolvable_4_4_k2", 4, 4, 2, 20000, true);
+    add_single(workloads, "unsolvable_6_6_k3", 6, 6, 3, 20000, true);
+    add_single(workloads, "large_solvable_200000_199990_k2", 200000, 199990, 2, 1);
+    add_single(workloads, "large_unsolvable_1000000_k2", 1000000, 1000000, 2, 1, true);
+    add_single(workloads, "large_unsolvable_200000_k3", 200000, 200000, 3, 1, true);
+    add_single(workloads, "wide_boat_200_100_k100", 200, 100, 100, 1);
+    add_grid(workloads, "grid_40x40_k1_6", 40, 40, 1, 6);
+    add_grid(workloads, "grid_80x80_k4", 80, 80, 4, 4);
+}
+
+// Resuelve un problema igual que solve_mc pero sin revisar antes is_solvable
+bool solve_full_search(const BatchJob &job, vector<State> &path, SolverAlgorithm algorithm, SolveStats *stats, SolverWorkspace &workspace)
+{
+    State initial_state = State::make(job.missionaries, job.cannibals, 0);
+    stats->states_expanded = 0;
+    stats->visited_bytes = 0;
+    stats->search_bytes = 0;
+    if (!is_valid(initial_state, job.missionaries, job.cannibals))
+        return false;
+    return run_algorithm(workspace, algorithm, initial_state, job.missionaries, job.cannibals, job.boat_capacity, path, stats, nullptr);
+}
+
+// Resuelve una vez todas las iteraciones del conjunto, si result no es nulo guarda en el los estados, la memoria y los
+// problemas con solución
+void run_workload_pass(const Workload &workload, SolverAlgorithm algorithm, WorkloadResult *result)
+{
+    // Un workspace nuevo en cada pasada para que todas midan lo mismo, incluyendo reservar la memoria
+    SolverWorkspace workspace;
+    vector<State> path;
+    SolveStats stats;
+    for (int i = 0; i < workload.iterations; ++i)
+    {
+        for (size_t j = 0; j < workload.jobs.size(); ++j)
+        {
+            const BatchJob &job = workload.jobs[j];
+            path.clear();
+            bool solved = workload.full_search ? solve_full_search(job, path, algorithm, &stats, workspace)
+                                               : solve_mc(job.missionaries, job.cannibals, job.boat_capacity, path, algorithm, &stats, &workspace);
+            if (!result)
+                continue;
+            if (solved && i == 0)
+                result->solved++;
+            result->states_expanded += stats.states_expanded;
+            result->peak_visited_bytes = max(result->peak_visited_bytes, stats.visited_bytes);
+            result->peak_search_bytes = max(result->peak_search_bytes, stats.search_bytes);
+        }
+    }
+}
+
+// Mide un conjunto de problemas con un algoritmo. Cada medición hace pasadas completas hasta llegar a MIN_MEASURE_SECONDS y
+// toma el tiempo promedio de una pasada, se hacen repeat mediciones y se reporta la mediana para reducir el ruido de otros
+// procesos. Los estados y la memoria no cambian entre pasadas, se cuentan en una primera pasada que no se mide y que
+// también sirve de calentamiento
+WorkloadResult run_workload(const Workload &workload, SolverAlgorithm algorithm, int repeat)
+{
+    WorkloadResult result;
+    result.name = workload.name;
+    result.algorithm = algorithm;
+    result.problems = (int)workload.jobs.size();
+    result.iterations = workload.iterations;
+    result.solved = 0;
+    result.states_expanded = 0;
+    result.peak_visited_bytes = 0;
+    result.peak_search_bytes = 0;
+    result.runs = 0;
+
+    run_workload_pass(workload, algorithm, &result);
+
+    vector<double> samples;
+    for (int r = 0; r < repeat; ++r)
+    {
+        long long runs = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        chrono::duration<double> elapsed(0);
+        while (runs == 0 || elapsed.count() < MIN_MEASURE_SECONDS)
+        {
+            run_workload_pass(workload, algorithm, nullptr);
+            runs++;
+            elapsed = chrono::steady_clock::now() - start;
+        }
+        samples.push_back(elapsed.count() / runs);
+        result.runs = max(result.runs, runs);
+    }
+
+    sort(samples.begin(), samples.end());
+    result.seconds = samples[samples.size() / 2];
+    return result;
+}
+
+// Nombre con el que se identifica un resultado en el JSON, por ejemplo "classic_3_3/bfs"
+string result_key(const string &name, SolverAlgorithm algorithm)
+{
+    return name + "/" + algorithm_id(algorithm);
+}
+
+// Escribe los resultados en JSON, cada resultado va en su propia linea para que read_baseline lo pueda leer sin necesitar
+// una librería de JSON
+void write_json(ostream &out, const vector<WorkloadResult> &results, int repeat)
+{
+    out << "{\n";
+    out << "  \"benchmark\": \"mc_bench\",\n";
+    out << "  \"repeat\": " << repeat << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const WorkloadResult &r = results[i];
+        double states_per_second = r.seconds > 0 ? r.states_expanded / r.seconds : 0;
+        out << "    {\"key\": \"" << result_key(r.name, r.algorithm) << "\", \"problems\": " << r.problems << ", \"iterations\": " << r.iterations
+            << ", \"solved\": " << r.solved
+            << ", \"states_expanded\": " << r.states_expanded << ", \"states_per_second\": " << (long long)states_per_second
+            << ", \"peak_visited_bytes\": " << r.peak_visited_bytes << ", \"peak_search_bytes\": " << r.peak_search_bytes
+            << ", \"seconds\": " << r.seconds << ", \"runs\": " << r.runs << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+// Busca el valor numérico de un campo ("campo": valor) dentro de una linea del JSON
+bool find_number(const string &line, const string &field, double &value)
+{
+    size_t pos = line.find("\"" + field + "\":");
+    if (pos == string::npos)
+        return false;
+    value = strtod(line.c_str() + pos + field.size() + 3, nullptr);
+    return true;
+}
+
+// Lee un JSON escrito por write_json y devuelve los resultados que contiene, solo llena los campos que se comparan
+bool read_baseline(istream &in, vector<WorkloadResult> &results, vector<string> &keys)
+{
+    string line;
+    while (getline(in, line))
+    {
+        size_t pos = line.find("\"key\": \"");
+        if (pos == string::npos)
+            continue;
+        size_t start = pos + 8;
+        size_t end = line.find('"', start);
+        if (end == string::npos)
+            return false;
+
+        WorkloadResult r;
+        double states, visited, seconds;
+        if (!find_number(line, "states_expanded", states) || !find_number(line, "peak_visited_bytes", visited) ||
+            !find_number(line, "seconds", seconds))
+            return false;
+        r.states_expanded = (long long)states;
+        r.peak_visited_bytes = (size_t)visited;
+        r.seconds = seconds;
+        keys.push_back(line.substr(start, end - start));
+        results.push_back(r);
+    }
+    return !results.empty();
+}
+
+// Compara los resultados contra los de la linea base y devuelve cuantas regresiones hubo. El tiempo es una regresión si crece
+// mas del umbral, pero solo si alguno de los 2 tiempos llega a min_seconds, por debajo de eso las diferencias son ruido. Los
+// estados expandidos y la memoria no dependen de la maquina, por lo que cualquier aumento cuenta
+int compare_results(const vector<WorkloadResult> &results, const vector<WorkloadResult> &baseline, const vector<string> &baseline_keys,
+                    double threshold, double min_seconds)
+{
+    int regressions = 0;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const WorkloadResult &r = results[i];
+        string key = result_key(r.name, r.algorithm);
+        size_t b = find(baseline_keys.begin(), baseline_keys.end(), key) - baseline_keys.begin();
+        if (b == baseline_keys.size())
+        {
+            cerr << key << ": not in baseline" << endl;
+            continue;
+        }
+        const WorkloadResult &base = baseline[b];
+
+        double ratio = base.seconds > 0 ? r.seconds / base.seconds : 1.0;
+        bool slower = ratio > 1.0 + threshold && max(r.seconds, base.seconds) >= min_seconds;
+        bool more_states = r.states_expanded > base.states_expanded;
+        bool more_memory = r.peak_visited_bytes > base.peak_visited_bytes;
+
+        cerr << key << ": " << r.seconds << " s vs " << base.seconds << " s (x" << ratio << ")";
+        if (slower)
+            cerr << " SLOWER";
+        if (more_states)
+            cerr << " MORE STATES (" << r.states_expanded << " vs " << base.states_expanded << ")";
+        if (more_memory)
+            cerr << " MORE MEMORY (" << r.peak_visited_bytes << " vs " << base.peak_visited_bytes << " bytes)";
+        cerr << endl;
+
+        if (slower || more_states || more_memory)
+            regressions++;
+    }
+    return regressions;
+}
+
+// Muestra como se usa el programa
+void print_usage(const char *program)
+{
+    cerr << "Usage: " << program << " [--repeat N] [-o results.json] [--compare baseline.json] [--threshold 0.10] [--min-time 0.001]" << endl;
+    cerr << "  --repeat N         measure each workload N times and keep the median (default 5), each measurement runs the" << endl;
+    cerr << "                     workload for at least " << MIN_MEASURE_SECONDS << " s" << endl;
+    cerr << "  -o FILE            write the JSON results to FILE instead of printing them" << endl;
+    cerr << "  --compare FILE     compare against a saved run and exit with code 2 if there is a regression" << endl;
+    cerr << "  --threshold X      allowed slowdown before the time counts as a regression (default 0.10 = 10%)" << endl;
+    cerr << "  --min-time S       time in seconds below which a slowdown is not a regression (default 0.001)" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int repeat = 5;
+    string output_file;
+    string baseline_file;
+    double threshold = 0.10;
+    double min_seconds = 0.001;
+
+    /* ------ Leer argumentos ------ */
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc)
+            repeat = atoi(argv[++i]);
+        else if (arg == "-o" && i + 1 < argc)
+            output_file = argv[++i];
+        else if (arg == "--compare" && i + 1 < argc)
+            baseline_file = argv[++i];
+        else if (arg == "--threshold" && i + 1 < argc)
+            threshold = atof(argv[++i]);
+        else if (arg == "--min-time" && i + 1 < argc)
+            min_seconds = atof(argv[++i]);
+        else
+        {
+            print_usage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+    if (repeat < 1 || threshold < 0 || min_seconds < 0)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Leemos la linea base antes de medir, para no esperar todo el benchmark si el archivo no sirve
+    vector<WorkloadResult> baseline;
+    vector<string> baseline_keys;
+    if (!baseline_file.empty())
+    {
+        ifstream in(baseline_file.c_str());
+        if (!in.is_open() || !read_baseline(in, baseline, baseline_keys))
+        {
+            cerr << "Error: Could not read the baseline " << baseline_file << "." << endl;
+            return 1;
+        }
+    }
+
+    /* ------ Medir ------ */
+
+    vector<Workload> workloads;
+    build_workloads(workloads);
+
+    vector<WorkloadResult> results;
+    for (size_t i = 0; i < workloads.size(); ++i)
+    {
+        for (int a = 0; a < ALGORITHM_COUNT; ++a)
+        {
+            SolverAlgorithm algorithm = (SolverAlgorithm)a;
+            results.push_back(run_workload(workloads[i], algorithm, repeat));
+            cerr << result_key(workloads[i].name, algorithm) << ": " << results.back().seconds << " s" << endl;
+        }
+    }
+
+    /* ------ Escribir los resultados ------ */
+
+    if (output_file.empty())
+    {
+        write_json(cout, results, repeat);
+    }
+    else
+    {
+        ofstream out(output_file.c_str());
+        if (!out.is_open())
+        {
+            cerr << "Error: Could not open " << output_file << " to save the results." << endl;
+            return 1;
+        }
+        write_json(out, results, repeat);
+    }
+
+    if (!baseline.empty())
+    {
+        int regressions = compare_results(results, baseline, baseline_keys, threshold, min_seconds);
+        cerr << regressions << " regression(s) against " << baseline_file << endl;
+        // Igual que en mc_cli, el código 2 no es un error de uso, para que los scripts lo puedan distinguir
+        if (regressions > 0)
+            return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,226 @@
+// Cache de soluciones: guarda el resultado de cada problema resuelto (el camino, o que no tiene solución) con la llave
+// (misioneros, caníbales, capacidad, algoritmo), asi repetir un problema (reiniciar la simulación con ESPACIO, volver a
+// correr un lote) no vuelve a buscar. Vive en memoria con una politica LRU (se descarta lo que lleva mas tiempo sin usarse)
+// y se puede guardar en un archivo para cargarlo la próxima vez que se abra el programa
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "solver.h"
+// Librerías estándar de c++
+#include <iostream>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <cstring>
+
+using namespace std;
+
+// Archivo donde la simulación guarda el cache entre ejecuciones
+const char *const DEFAULT_CACHE_FILE = "solutions.cache";
+// Limite de estados guardados entre todos los caminos del cache (32 MB), los problemas sin solución no ocupan estados
+const size_t DEFAULT_CACHE_MAX_STATES = size_t(1) << 22;
+// Encabezado del archivo, el numero al final es la versión del formato y se debe de cambiar si cambia el formato o si el
+// solucionador empieza a dar caminos distintos para el mismo problema, asi los archivos viejos simplemente se ignoran. La
+// versión 2 es la de is_solvable: los problemas sin solución ya no expanden estados, por lo que las estadísticas guardadas
+// por la versión 1 no coinciden con las nuevas
+const char CACHE_FILE_MAGIC[8] = {'M', 'C', 'C', 'A', 'C', 'H', 'E', '2'};
+
+// Llave de un problema dentro del cache
+struct SolveKey
+{
+    int missionaries, cannibals, boat_capacity;
+    SolverAlgorithm algorithm;
+
+    bool operator==(const SolveKey &other) const
+    {
+        return missionaries == other.missionaries && cannibals == other.cannibals && boat_capacity == other.boat_capacity &&
+               algorithm == other.algorithm;
+    }
+};
+
+// Función hash de la llave para unordered_map
+struct SolveKeyHash
+{
+    size_t operator()(const SolveKey &key) const
+    {
+        uint64_t h = uint64_t(key.missionaries) * 0x9E3779B97F4A7C15ULL;
+        h ^= uint64_t(key.cannibals) + 0x7F4A7C159E3779B9ULL + (h << 6) + (h >> 2);
+        h ^= uint64_t(key.boat_capacity * ALGORITHM_COUNT + key.algorithm) + (h << 6) + (h >> 2);
+        return size_t(h);
+    }
+};
+
+// Resultado guardado de un problema
+struct CachedSolution
+{
+    bool solved;
+    // Estados que expandió la búsqueda original, para seguir mostrando las mismas estadísticas
+    long long states_expanded;
+    // Camino de la solución (vacío si no tiene solución)
+    vector<State> path;
+};
+
+// Cache LRU de soluciones, se puede usar desde varios hilos a la vez (el modo por lotes), cada operación toma el mutex
+struct SolutionCache
+{
+    typedef list<pair<SolveKey, CachedSolution> > EntryList;
+
+    mutex lock;
+    // Entradas de la mas reciente (al frente) a la que lleva mas tiempo sin usarse (al final)
+    EntryList entries;
+    unordered_map<SolveKey, EntryList::iterator, SolveKeyHash> index;
+    // Estados guardados entre todos los caminos y el máximo permitido
+    size_t stored_states;
+    size_t max_states;
+    // Veces que se encontró (o no) un problema, para mostrarlo en las estadísticas
+    long long hits, misses;
+
+    SolutionCache(size_t max_states_ = DEFAULT_CACHE_MAX_STATES) : stored_states(0), max_states(max_states_), hits(0), misses(0) {}
+
+    // Busca un problema, si esta en el cache lo marca como el mas reciente, copia el resultado a result y devuelve true
+    bool lookup(const SolveKey &key, CachedSolution &result)
+    {
+        lock_guard<mutex> guard(lock);
+        auto found = index.find(key);
+        if (found == index.end())
+        {
+            misses++;
+            return false;
+        }
+        hits++;
+        entries.splice(entries.begin(), entries, found->second);
+        result = found->second->second;
+        return true;
+    }
+
+    // Guarda el resultado de un problema (reemplazando el anterior si ya estaba), si el camino no cabe en el limite no se
+    // guarda, y si al agregarlo se pasa del limite se descartan las entradas menos recientes
+    void store(const SolveKey &key, bool solved, long long states_expanded, const vector<State> &path)
+    {
+        lock_guard<mutex> guard(lock);
+        if (path.size() > max_states)
+            return;
+        erase_locked(key);
+
+        CachedSolution solution;
+        solution.solved = solved;
+        solution.states_expanded = states_expanded;
+        solution.path = path;
+        entries.push_front(make_pair(key, move(solution)));
+        index[key] = entries.begin();
+        stored_states += path.size();
+
+        while (stored_states > max_states)
+            erase_locked(entries.back().first);
+    }
+
+    size_t size()
+    {
+        lock_guard<mutex> guard(lock);
+        return entries.size();
+    }
+
+    // Lee un archivo escrito por save(), devuelve false si no es un archivo de cache de esta versión, si esta incompleto o si
+    // tiene una entrada que no es valida (en ese caso se quedan las entradas que se alcanzaron a leer). Los caminos se revisan
+    // paso por paso ya que después se dibujan y se escriben tal cual
+    bool load(istream &in)
+    {
+        char magic[sizeof(CACHE_FILE_MAGIC)];
+        if (!in.read(magic, sizeof(magic)) || memcmp(magic, CACHE_FILE_MAGIC, sizeof(magic)) != 0)
+            return false;
+
+        // Cada entrada es: misioneros, caníbales, capacidad, algoritmo, resuelto (int32), estados expandidos (int64),
+        // numero de estados del camino (uint64) y después los estados tal cual se guardan en State
+        vector<State> path;
+        while (in.peek() != EOF)
+        {
+            int32_t fields[5];
+            int64_t states_expanded;
+            uint64_t length;
+            if (!in.read((char *)fields, sizeof(fields)) || !in.read((char *)&states_expanded, sizeof(states_expanded)) ||
+                !in.read((char *)&length, sizeof(length)) || length > max_states)
+                return false;
+            path.resize((size_t)length);
+            if (length > 0 && !in.read((char *)&path[0], length * sizeof(State)))
+                return false;
+
+            if (fields[0] < 0 || fields[0] > (int32_t)State::COUNT_MASK || fields[1] < 0 || fields[1] > (int32_t)State::COUNT_MASK ||
+                fields[2] < 1 || fields[2] > MAX_BOAT_CAPACITY || fields[3] < 0 || fields[3] >= ALGORITHM_COUNT)
+                return false;
+            // Un problema resuelto debe tener un camino completo y uno sin solución ninguno
+            if (fields[4] != 0 ? !is_solution_path(path, fields[0], fields[1], fields[2]) : !path.empty())
+                return false;
+            SolveKey key = {fields[0], fields[1], fields[2], (SolverAlgorithm)fields[3]};
+            store(key, fields[4] != 0, states_expanded, path);
+        }
+        return true;
+    }
+
+    // Escribe todas las entradas, de la menos reciente a la mas reciente para que al cargarlas se conserve el orden
+    bool save(ostream &out)
+    {
+        lock_guard<mutex> guard(lock);
+        out.write(CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+        for (EntryList::reverse_iterator it = entries.rbegin(); it != entries.rend(); ++it)
+        {
+            const SolveKey &key = it->first;
+            const CachedSolution &solution = it->second;
+            int32_t fields[5] = {key.missionaries, key.cannibals, key.boat_capacity, (int32_t)key.algorithm, solution.solved ? 1 : 0};
+            int64_t states_expanded = solution.states_expanded;
+            uint64_t length = solution.path.size();
+            out.write((const char *)fields, sizeof(fields));
+            out.write((const char *)&states_expanded, sizeof(states_expanded));
+            out.write((const char *)&length, sizeof(length));
+            if (length > 0)
+                out.write((const char *)&solution.path[0], length * sizeof(State));
+        }
+        out.flush();
+        return (bool)out;
+    }
+
+    // Quita una entrada, se debe de llamar con el mutex tomado
+    void erase_locked(const SolveKey &key)
+    {
+        auto found = index.find(key);
+        if (found == index.end())
+            return;
+        stored_states -= found->second->second.path.size();
+        entries.erase(found->second);
+        index.erase(found);
+    }
+};
+
+// Resuelve el problema usando el cache: si ya estaba guardado copia el resultado sin buscar, si no, lo resuelve con solve_mc
+// y guarda el resultado, devuelve si tiene solución y en from_cache si el resultado salió del cache
+inline bool solve_mc_cached(SolutionCache &cache, int initial_m, int initial_c, int boat_capacity, vector<State> &path,
+                            SolverAlgorithm algorithm, SolveStats *stats, SolverWorkspace *workspace, bool &from_cache)
+{
+    SolveKey key = {initial_m, initial_c, boat_capacity, algorithm};
+    CachedSolution cached;
+    from_cache = cache.lookup(key, cached);
+    if (from_cache)
+    {
+        path.insert(path.end(), cached.path.begin(), cached.path.end());
+        if (stats)
+        {
+            stats->states_expanded = cached.states_expanded;
+            stats->visited_bytes = 0;
+            stats->search_bytes = 0;
+        }
+        return cached.solved;
+    }
+
+    SolveStats local_stats;
+    if (!stats)
+        stats = &local_stats;
+    size_t first = path.size();
+    bool solved = solve_mc(initial_m, initial_c, boat_capacity, path, algorithm, stats, workspace);
+    if (first == 0)
+        cache.store(key, solved, stats->states_expanded, path);
+    else
+        cache.store(key, solved, stats->states_expanded, vector<State>(path.begin() + first, path.end()));
+    return solved;
+}
+
+#endif
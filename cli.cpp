@@ -0,0 +1,507 @@
+// Versión de linea de comandos del solucionador, no usa allegro (ni crea pantalla, temporizador o fuente), por lo que se puede
+// usar en servidores sin pantalla, resuelve un solo problema (o un lote de problemas en paralelo), imprime o guarda el
+// resultado y termina
+#include "solver.h"
+#include "batch.h"
+#include "cache.h"
+#include "results_io.h"
+#include "optimal_paths.h"
+#include "puzzle_engine.h"
+// Librerías estándar de c++
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <iomanip>
+
+using namespace std;
+
+// Muestra como se usa el programa
+void print_usage(const char *program)
+{
+    cerr << "Usage: " << program << " <missionaries> <cannibals> [capacity] [dfs|bfs|bidi|astar] [-o results.txt] [--format text|binary] [--cache FILE]" << endl;
+    cerr << "       " << program << " <missionaries> <cannibals> [capacity] --check" << endl;
+    cerr << "       " << program << " <missionaries> <cannibals> [capacity] --compare" << endl;
+    cerr << "       " << program << " <missionaries> <cannibals> [capacity] --count-shortest [--list N]" << endl;
+    cerr << "       " << program << " <missionaries> <cannibals> [capacity] --variant classic|banks-only|rower|husbands|two-boats [--second-boat K] [-o results.txt]" << endl;
+    cerr << "       " << program << " --batch <missionaries> <cannibals> <capacities> [algorithms] [--threads N] [-o results.csv] [--cache FILE]" << endl;
+    cerr << "       " << program << " --batch-file <jobs.txt> [--threads N] [-o results.csv] [--cache FILE]" << endl;
+    cerr << "  capacity   boat capacity, between 1 and " << MAX_BOAT_CAPACITY << " (default " << DEFAULT_BOAT_CAPACITY << ")" << endl;
+    cerr << "  dfs|bfs|bidi|astar  search algorithm (default dfs), bidi is a bidirectional BFS" << endl;
+    cerr << "  -o FILE    write the solution to FILE instead of printing it" << endl;
+    cerr << "  --format   text (default) or binary, a compact format that needs -o and can be read back with mc_path" << endl;
+    cerr << "  --cache FILE  reuse the results saved in FILE and save the new ones to it (it is created if missing)" << endl;
+    cerr << "  --check    only tell whether there is a solution, without searching for it (also --solvable-only in batch mode)" << endl;
+    cerr << "  --compare  solve with every algorithm and print the moves, states expanded and time of each" << endl;
+    cerr << "  --count-shortest  print how many different shortest solutions there are, --list N also prints the first N" << endl;
+    cerr << "             as the groups that cross in each trip" << endl;
+    cerr << "  --variant  rules of the puzzle: classic (default, the boat must be safe too), banks-only (only the banks are" << endl;
+    cerr << "             checked), rower (only the missionaries and one cannibal can row) or husbands (jealous husbands, the" << endl;
+    cerr << "             missionaries and cannibals are the husbands and wives, so both must be the same and at most " << MAX_COUPLES << ")" << endl;
+    cerr << "             or two-boats (a second boat, each trip uses one of them), every variant is solved with BFS on the" << endl;
+    cerr << "             same generic engine, classic also with the other algorithms" << endl;
+    cerr << "  --second-boat K  capacity of the second boat in the two-boats variant (default the same capacity)" << endl;
+    cerr << "  In batch mode each value is a list of numbers or ranges, for example 1:100 or 2,3,4 or 0:1000:10," << endl;
+    cerr << "  algorithms is a list such as dfs,bfs,astar, and jobs.txt has one \"missionaries cannibals capacity [algorithm]\"" << endl;
+    cerr << "  per line. The results are written as CSV in the same order as the input." << endl;
+}
+
+// Carga el cache desde un archivo, si el archivo no existe se empieza con el cache vacío
+void load_cache_file(SolutionCache &cache, const string &cache_file)
+{
+    ifstream in(cache_file.c_str(), ios::binary);
+    if (in.is_open() && !cache.load(in))
+        cerr << "Warning: " << cache_file << " is not a valid cache file, only the entries read so far are used." << endl;
+}
+
+// Guarda el cache en un archivo
+bool save_cache_file(SolutionCache &cache, const string &cache_file)
+{
+    ofstream out(cache_file.c_str(), ios::binary);
+    if (!out.is_open() || !cache.save(out))
+    {
+        cerr << "Error: Could not save the cache in " << cache_file << "." << endl;
+        return false;
+    }
+    return true;
+}
+
+// Modo por lotes, resuelve todos los problemas de una malla de valores o de un archivo en paralelo y escribe un CSV con los
+// resultados en el mismo orden de entrada
+int run_batch_mode(int argc, char *argv[])
+{
+    vector<BatchJob> jobs;
+    int num_threads = (int)thread::hardware_concurrency();
+    string output_file;
+    string cache_file;
+    // Si solo se quiere saber que problemas tienen solución, sin buscar los caminos
+    bool solvable_only = false;
+
+    // Valores de la malla (modo --batch) o archivo con los problemas (modo --batch-file)
+    vector<int> missionaries, cannibals, capacities;
+    vector<SolverAlgorithm> algorithms;
+    string jobs_file;
+    bool from_file = string(argv[1]) == "--batch-file";
+
+    int positional = 0;
+    for (int i = 2; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc)
+            output_file = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc)
+            num_threads = atoi(argv[++i]);
+        else if (arg == "--cache" && i + 1 < argc)
+            cache_file = argv[++i];
+        else if (arg == "--solvable-only")
+            solvable_only = true;
+        else if (from_file && positional == 0)
+        {
+            jobs_file = arg;
+            positional++;
+        }
+        else if (!from_file && positional == 0 && parse_int_list(arg, missionaries))
+            positional++;
+        else if (!from_file && positional == 1 && parse_int_list(arg, cannibals))
+            positional++;
+        else if (!from_file && positional == 2 && parse_int_list(arg, capacities))
+            positional++;
+        else if (!from_file && positional == 3 && parse_algorithm_list(arg, algorithms))
+            positional++;
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (from_file)
+    {
+        if (positional < 1)
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+        ifstream in(jobs_file.c_str());
+        if (!in.is_open())
+        {
+            cerr << "Error: Could not open " << jobs_file << "." << endl;
+            return 1;
+        }
+        int line_number;
+        if (!read_batch_file(in, jobs, line_number))
+        {
+            cerr << "Error: invalid job in " << jobs_file << " at line " << line_number << "." << endl;
+            return 1;
+        }
+    }
+    else
+    {
+        if (positional < 3)
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+        // Si no se dio el algoritmo se usa DFS, igual que en el modo de un solo problema
+        if (algorithms.empty())
+            algorithms.push_back(ALGORITHM_DFS);
+        for (size_t k = 0; k < capacities.size(); ++k)
+        {
+            if (capacities[k] < 1 || capacities[k] > MAX_BOAT_CAPACITY)
+            {
+                cerr << "Error: boat capacity must be between 1 and " << MAX_BOAT_CAPACITY << "." << endl;
+                return 1;
+            }
+        }
+        build_batch_grid(missionaries, cannibals, capacities, algorithms, jobs);
+    }
+
+    /* ------ Resolver el lote ------ */
+
+    if (num_threads < 1)
+        num_threads = 1;
+    SolutionCache cache;
+    if (!cache_file.empty())
+        load_cache_file(cache, cache_file);
+
+    vector<BatchResult> results;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (solvable_only)
+        run_batch_solvability(jobs, results);
+    else
+        run_batch(jobs, results, num_threads, cache_file.empty() ? nullptr : &cache);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    cerr << jobs.size() << " problems solved with " << num_threads << " threads in " << elapsed.count() << " s" << endl;
+    if (!cache_file.empty())
+    {
+        cerr << cache.hits << " of them were already in " << cache_file << endl;
+        if (!save_cache_file(cache, cache_file))
+            return 1;
+    }
+
+    /* ------ Escribir los resultados ------ */
+
+    if (output_file.empty())
+    {
+        write_batch_results(cout, jobs, results);
+    }
+    else
+    {
+        ofstream results_file(output_file.c_str());
+        if (!results_file.is_open())
+        {
+            cerr << "Error: Could not open " << output_file << " to save the results." << endl;
+            return 1;
+        }
+        write_batch_results(results_file, jobs, results);
+    }
+
+    return 0;
+}
+
+// Resuelve el mismo problema con cada algoritmo e imprime una tabla con los movimientos de la solución, los estados que
+// expandió y el tiempo que tardo cada uno
+int run_compare(int num_missionaries, int num_cannibals, int boat_capacity)
+{
+    SolverWorkspace workspace;
+    bool any_solved = false;
+    cout << left << setw(10) << "algorithm" << setw(12) << "moves" << setw(18) << "states_expanded" << "seconds" << endl;
+    for (int a = 0; a < ALGORITHM_COUNT; ++a)
+    {
+        SolverAlgorithm algorithm = (SolverAlgorithm)a;
+        vector<State> solution_path;
+        SolveStats stats;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        bool solved = solve_mc(num_missionaries, num_cannibals, boat_capacity, solution_path, algorithm, &stats, &workspace);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        any_solved = any_solved || solved;
+
+        cout << setw(10) << algorithm_name(algorithm) << setw(12);
+        if (solved)
+            cout << solution_path.size() - 1;
+        else
+            cout << "-";
+        cout << setw(18) << stats.states_expanded << seconds << endl;
+    }
+    return any_solved ? 0 : 2;
+}
+
+// Cuenta las soluciones mas cortas y muestra las primeras list_count, cada una en una linea con el grupo que cruzo en cada
+// viaje (misioneros/caníbales), las soluciones se generan una por una por lo que list_count puede ser tan grande como se quiera
+int run_count_shortest(int num_missionaries, int num_cannibals, int boat_capacity, long long list_count)
+{
+    ShortestPathDag dag;
+    if (!dag.build(num_missionaries, num_cannibals, boat_capacity))
+    {
+        cout << "NO SOLUTION FOUND for these values." << endl;
+        return 2;
+    }
+    cout << "Shortest solutions: " << dag.count_paths().to_string() << " (" << dag.length << " moves each)" << endl;
+
+    ShortestPathEnumerator enumerator;
+    enumerator.start(dag);
+    vector<State> solution_path;
+    while (enumerator.produced < list_count && enumerator.next(solution_path))
+    {
+        cout << enumerator.produced << ":";
+        for (size_t i = 1; i < solution_path.size(); ++i)
+            cout << ' ' << abs(solution_path[i].m_left() - solution_path[i - 1].m_left()) << '/'
+                 << abs(solution_path[i].c_left() - solution_path[i - 1].c_left());
+        cout << '\n';
+    }
+    cout.flush();
+    return 0;
+}
+
+// Resuelve una variante con el motor genérico y muestra o guarda el camino, con los mismos códigos de salida que el modo normal
+template <class Rules>
+int solve_variant(const Rules &rules, const string &title, const string &output_file)
+{
+    if (rules.move_count() > MAX_PUZZLE_MOVES)
+    {
+        cerr << "Error: too many different groups fit in the boat for this variant." << endl;
+        return 1;
+    }
+
+    vector<typename Rules::StateType> solution_path;
+    SolveStats stats;
+    bool solved = solve_puzzle(rules, solution_path, &stats);
+    cerr << "bfs: " << stats.states_expanded << " states expanded" << endl;
+    if (!solved)
+    {
+        cout << "NO SOLUTION FOUND for these values." << endl;
+        return 2;
+    }
+
+    if (output_file.empty())
+    {
+        write_puzzle_results(cout, rules, solution_path, title.c_str());
+        return 0;
+    }
+    ofstream results_file(output_file.c_str());
+    if (!results_file.is_open())
+    {
+        cerr << "Error: Could not open " << output_file << " to save the results." << endl;
+        return 1;
+    }
+    write_puzzle_results(results_file, rules, solution_path, title.c_str());
+    return 0;
+}
+
+// Elige las reglas de la variante y la resuelve
+int run_variant(PuzzleVariant variant, int num_missionaries, int num_cannibals, int boat_capacity, int second_capacity,
+                const string &output_file)
+{
+    string capacity_line = "\nBoat capacity: " + to_string(boat_capacity);
+    string counts = "Missionaries: " + to_string(num_missionaries) + ", Cannibals: " + to_string(num_cannibals);
+    if (variant == VARIANT_BANKS_ONLY)
+        return solve_variant(MissionaryRules<false>(num_missionaries, num_cannibals, boat_capacity), counts + " (banks only)" + capacity_line, output_file);
+    if (variant == VARIANT_ROWER)
+        return solve_variant(RowerRules(num_missionaries, num_cannibals, boat_capacity), counts + " (one cannibal rows)" + capacity_line, output_file);
+    if (variant == VARIANT_TWO_BOATS)
+        return solve_variant(TwoBoatRules(num_missionaries, num_cannibals, boat_capacity, second_capacity),
+                             counts + " (two boats)" + capacity_line + "\nSecond boat capacity: " + to_string(second_capacity), output_file);
+
+    if (num_missionaries != num_cannibals || num_missionaries > MAX_COUPLES)
+    {
+        cerr << "Error: the husbands variant needs the same number of missionaries and cannibals, at most " << MAX_COUPLES << "." << endl;
+        return 1;
+    }
+    return solve_variant(JealousHusbandsRules(num_missionaries, boat_capacity), "Jealous husbands: " + to_string(num_missionaries) + " couples" + capacity_line,
+                         output_file);
+}
+
+int main(int argc, char *argv[])
+{
+    // Si el primer argumento pide el modo por lotes, este se encarga de todo
+    if (argc > 1 && (string(argv[1]) == "--batch" || string(argv[1]) == "--batch-file"))
+        return run_batch_mode(argc, argv);
+
+    int num_missionaries = -1;
+    int num_cannibals = -1;
+    int boat_capacity = DEFAULT_BOAT_CAPACITY;
+    SolverAlgorithm algorithm = ALGORITHM_DFS;
+    // Archivo donde se guarda la solución, si esta vacío se imprime en la salida estándar
+    string output_file;
+    // Archivo del cache de soluciones, si esta vacío no se usa cache
+    string cache_file;
+    ResultsFormat results_format = RESULTS_TEXT;
+    // Si solo se quiere saber si tiene solución
+    bool check_only = false;
+    // Si se quiere resolver con todos los algoritmos para compararlos
+    bool compare = false;
+    // Si se quieren contar las soluciones mas cortas, y cuantas de ellas imprimir
+    bool count_shortest = false;
+    long long list_count = 0;
+    // Reglas del problema, las de la simulación o una de las variantes de puzzle_engine.h
+    PuzzleVariant variant = VARIANT_CLASSIC;
+    // Capacidad del segundo bote en la variante de 2 botes, 0 para usar la misma capacidad
+    int second_capacity = 0;
+
+    /* ------ Leer argumentos ------ */
+
+    // Los argumentos posicionales son, en orden: misioneros, caníbales, capacidad y algoritmo
+    int positional = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc)
+        {
+            output_file = argv[++i];
+        }
+        else if (arg == "--cache" && i + 1 < argc)
+        {
+            cache_file = argv[++i];
+        }
+        else if (arg == "--format" && i + 1 < argc && parse_results_format(argv[i + 1], results_format))
+        {
+            ++i;
+        }
+        else if (arg == "--check")
+        {
+            check_only = true;
+        }
+        else if (arg == "--compare")
+        {
+            compare = true;
+        }
+        else if (arg == "--count-shortest")
+        {
+            count_shortest = true;
+        }
+        else if (arg == "--list" && i + 1 < argc)
+        {
+            list_count = atoll(argv[++i]);
+        }
+        else if (arg == "--variant" && i + 1 < argc && parse_variant(argv[i + 1], variant))
+        {
+            ++i;
+        }
+        else if (arg == "--second-boat" && i + 1 < argc && parse_count(argv[i + 1], second_capacity))
+        {
+            ++i;
+        }
+        else if (arg == "-h" || arg == "--help")
+        {
+            print_usage(argv[0]);
+            return 0;
+        }
+        else if (positional == 0 && parse_count(argv[i], num_missionaries))
+            positional++;
+        else if (positional == 1 && parse_count(argv[i], num_cannibals))
+            positional++;
+        else if (positional == 2 && parse_count(argv[i], boat_capacity))
+            positional++;
+        // El algoritmo puede ir en lugar de la capacidad, en ese caso se usa la capacidad por defecto
+        else if ((positional == 2 || positional == 3) && parse_algorithm(arg, algorithm))
+            positional = 4;
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Los misioneros y caníbales son obligatorios
+    if (positional < 2)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (boat_capacity < 1 || boat_capacity > MAX_BOAT_CAPACITY)
+    {
+        cerr << "Error: boat capacity must be between 1 and " << MAX_BOAT_CAPACITY << "." << endl;
+        return 1;
+    }
+    // El formato binario no se imprime en la terminal
+    if (results_format == RESULTS_BINARY && output_file.empty())
+    {
+        cerr << "Error: the binary format needs an output file (-o)." << endl;
+        return 1;
+    }
+
+    if (second_capacity != 0 && variant != VARIANT_TWO_BOATS)
+    {
+        cerr << "Error: --second-boat only applies to the two-boats variant." << endl;
+        return 1;
+    }
+
+    // Las variantes solo se resuelven y se muestran, el resto de los modos son del problema clásico
+    if (variant != VARIANT_CLASSIC)
+    {
+        if (check_only || compare || count_shortest || !cache_file.empty() || results_format == RESULTS_BINARY || positional == 4)
+        {
+            cerr << "Error: --check, --compare, --count-shortest, --cache, --format and the algorithm only apply to the classic variant." << endl;
+            return 1;
+        }
+        if (second_capacity == 0)
+            second_capacity = boat_capacity;
+        if (second_capacity < 1 || second_capacity > MAX_BOAT_CAPACITY)
+        {
+            cerr << "Error: the second boat capacity must be between 1 and " << MAX_BOAT_CAPACITY << "." << endl;
+            return 1;
+        }
+        return run_variant(variant, num_missionaries, num_cannibals, boat_capacity, second_capacity, output_file);
+    }
+
+    // Para saber si tiene solución no hace falta buscar el camino
+    if (check_only)
+    {
+        bool solvable = is_solvable(num_missionaries, num_cannibals, boat_capacity);
+        cout << (solvable ? "SOLVABLE" : "NO SOLUTION FOUND for these values.") << endl;
+        return solvable ? 0 : 2;
+    }
+
+    if (compare)
+        return run_compare(num_missionaries, num_cannibals, boat_capacity);
+    if (count_shortest)
+        return run_count_shortest(num_missionaries, num_cannibals, boat_capacity, list_count);
+
+    /* ------ Resolver ------ */
+
+    vector<State> solution_path;
+    SolveStats stats;
+    bool solved, from_cache = false;
+    if (cache_file.empty())
+        solved = solve_mc(num_missionaries, num_cannibals, boat_capacity, solution_path, algorithm, &stats);
+    else
+    {
+        SolutionCache cache;
+        load_cache_file(cache, cache_file);
+        solved = solve_mc_cached(cache, num_missionaries, num_cannibals, boat_capacity, solution_path, algorithm, &stats, nullptr, from_cache);
+        if (!from_cache && !save_cache_file(cache, cache_file))
+            return 1;
+    }
+
+    // Las estadísticas van a la salida de errores para no mezclarse con la solución
+    cerr << algorithm_name(algorithm) << ": " << stats.states_expanded << " states expanded" << (from_cache ? " (cached)" : "") << endl;
+
+    if (!solved)
+    {
+        cout << "NO SOLUTION FOUND for these values." << endl;
+        // Usamos un código de salida distinto para que los scripts puedan distinguir este caso de un error
+        return 2;
+    }
+
+    /* ------ Mostrar o guardar el resultado ------ */
+
+    if (output_file.empty())
+    {
+        write_results(cout, solution_path, num_missionaries, num_cannibals, boat_capacity);
+    }
+    else
+    {
+        ofstream results_file(output_file.c_str(), results_format == RESULTS_BINARY ? ios::out | ios::binary : ios::out);
+        if (!results_file.is_open())
+        {
+            cerr << "Error: Could not open " << output_file << " to save the results." << endl;
+            return 1;
+        }
+        write_results_as(results_format, results_file, solution_path, num_missionaries, num_cannibals, boat_capacity);
+    }
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Exporta el grafo completo de estados alcanzables de un problema en formato DOT (Graphviz) o binario, marcando el camino de
+// la solución que encuentra el algoritmo elegido, no usa allegro
+#include "solver.h"
+#include "graph_export.h"
+// Librerías estándar de c++
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+
+// Muestra como se usa el programa
+void print_usage(const char *program)
+{
+    cerr << "Usage: " << program << " <missionaries> <cannibals> [capacity] [dfs|bfs|bidi|astar|none] [-o graph.dot] [--format dot|binary]" << endl;
+    cerr << "  capacity   boat capacity, between 1 and " << MAX_BOAT_CAPACITY << " (default " << DEFAULT_BOAT_CAPACITY << ")" << endl;
+    cerr << "  algorithm  algorithm whose solution is highlighted (default bfs), none to skip it" << endl;
+    cerr << "  -o FILE    write the graph to FILE instead of printing it" << endl;
+    cerr << "  --format   dot (default, for Graphviz) or binary, a compact record list that needs -o" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int num_missionaries = -1;
+    int num_cannibals = -1;
+    int boat_capacity = DEFAULT_BOAT_CAPACITY;
+    SolverAlgorithm algorithm = ALGORITHM_BFS;
+    bool mark_solution = true;
+    string output_file;
+    GraphFormat format = GRAPH_DOT;
+
+    /* ------ Leer argumentos ------ */
+
+    int positional = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc)
+            output_file = argv[++i];
+        else if (arg == "--format" && i + 1 < argc && parse_graph_format(argv[i + 1], format))
+            ++i;
+        else if (arg == "-h" || arg == "--help")
+        {
+            print_usage(argv[0]);
+            return 0;
+        }
+        else if (positional == 0 && parse_count(argv[i], num_missionaries))
+            positional++;
+        else if (positional == 1 && parse_count(argv[i], num_cannibals))
+            positional++;
+        else if (positional == 2 && parse_count(argv[i], boat_capacity))
+            positional++;
+        else if ((positional == 2 || positional == 3) && arg == "none")
+        {
+            mark_solution = false;
+            positional = 4;
+        }
+        else if ((positional == 2 || positional == 3) && parse_algorithm(arg, algorithm))
+            positional = 4;
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (positional < 2)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (boat_capacity < 1 || boat_capacity > MAX_BOAT_CAPACITY)
+    {
+        cerr << "Error: boat capacity must be between 1 and " << MAX_BOAT_CAPACITY << "." << endl;
+        return 1;
+    }
+    if (format == GRAPH_BINARY && output_file.empty())
+    {
+        cerr << "Error: the binary format needs an output file (-o)." << endl;
+        return 1;
+    }
+
+    /* ------ Resolver y exportar ------ */
+
+    vector<State> solution_path;
+    if (mark_solution)
+        solve_mc(num_missionaries, num_cannibals, boat_capacity, solution_path, algorithm);
+
+    GraphExportStats stats;
+    if (output_file.empty())
+    {
+        stats = export_state_graph(cout, format, num_missionaries, num_cannibals, boat_capacity, solution_path);
+    }
+    else
+    {
+        ofstream graph_file(output_file.c_str(), format == GRAPH_BINARY ? ios::out | ios::binary : ios::out);
+        if (!graph_file.is_open())
+        {
+            cerr << "Error: Could not open " << output_file << " to save the graph." << endl;
+            return 1;
+        }
+        stats = export_state_graph(graph_file, format, num_missionaries, num_cannibals, boat_capacity, solution_path);
+    }
+
+    cerr << stats.nodes << " states, " << stats.edges << " moves, " << stats.dead_ends << " dead ends, widest BFS level "
+         << stats.widest_level << " states";
+    if (mark_solution)
+        cerr << ", " << algorithm_name(algorithm) << " solution: " << (solution_path.empty() ? string("none") : to_string(solution_path.size() - 1) + " moves");
+    cerr << endl;
+    return 0;
+}
@@ -0,0 +1,211 @@
+// Exportación del grafo completo de estados alcanzables: cada estado valido al que se puede llegar desde el inicio y cada
+// viaje del bote entre ellos, marcando el inicio, la solución, los callejones sin salida y el camino de una solución. Se
+// recorre el espacio una sola vez con un BFS por niveles y cada nodo y arista se escribe en cuanto se conoce, sin guardar el
+// grafo, por lo que la memoria es la tabla de visitados (un bit por estado) mas el nivel mas ancho del BFS, no el numero de
+// aristas. Hay 2 formatos:
+// - DOT (Graphviz), para dibujarlo con dot o sfdp
+// - Binario: una lista de registros compacta donde cada nodo se identifica por su posición en VisitedTable
+#ifndef GRAPH_EXPORT_H
+#define GRAPH_EXPORT_H
+
+#include "solver.h"
+#include "results_io.h"
+// Librerías estándar de c++
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdio>
+
+using namespace std;
+
+// Formatos en los que se puede exportar el grafo
+enum GraphFormat
+{
+    GRAPH_DOT,   // Texto de Graphviz
+    GRAPH_BINARY // Registros binarios compactos
+};
+
+// Encabezado del formato binario, el numero al final es la versión del formato. Después del encabezado van los totales y la
+// capacidad (uint32) y el tamaño de la tabla de estados (uint64), seguidos de registros que empiezan con un byte:
+// - 'N': un nodo, su posición en VisitedTable (varint, se convierte de vuelta en estado con VisitedTable::state_at) y sus
+//   marcas (un byte con GRAPH_NODE_*)
+// - 'E': una arista, las posiciones de sus 2 nodos (varint), siempre del estado con el bote a la izquierda al de la derecha,
+//   y un byte que es 1 si la arista es parte del camino de la solución
+const char GRAPH_BINARY_MAGIC[8] = {'M', 'C', 'G', 'R', 'A', 'P', 'H', '1'};
+
+// Marcas de un nodo
+const unsigned char GRAPH_NODE_START = 1;    // Estado inicial
+const unsigned char GRAPH_NODE_GOAL = 2;     // Todos a la derecha
+const unsigned char GRAPH_NODE_DEAD_END = 4; // Solo se puede salir de el por donde se llego (un solo vecino)
+const unsigned char GRAPH_NODE_PATH = 8;     // Parte del camino de la solución
+
+// Convierte el nombre de un formato ("dot" o "binary") a su valor, devuelve false si no se reconoce
+inline bool parse_graph_format(const string &name, GraphFormat &format)
+{
+    if (name == "dot")
+        format = GRAPH_DOT;
+    else if (name == "binary" || name == "bin")
+        format = GRAPH_BINARY;
+    else
+        return false;
+    return true;
+}
+
+// Resumen del grafo exportado
+struct GraphExportStats
+{
+    long long nodes, edges, dead_ends;
+    // Estados en el nivel mas ancho del BFS, lo que define la memoria además de la tabla de visitados
+    size_t widest_level;
+};
+
+// Escribe un nodo en el formato elegido
+inline void write_graph_node(OutputBuffer &buffer, GraphFormat format, size_t index, const State &s, unsigned char flags)
+{
+    if (format == GRAPH_BINARY)
+    {
+        buffer.put('N');
+        buffer.put_varint(index);
+        buffer.put((char)flags);
+        return;
+    }
+
+    char line[200];
+    int length = snprintf(line, sizeof(line), "  s%llu [label=\"%d,%d %s\"", (unsigned long long)index, s.m_left(), s.c_left(),
+                          s.boat_pos() == 0 ? "L" : "R");
+    buffer.write(line, length);
+    if (flags & GRAPH_NODE_START)
+        buffer.write(", shape=box", 11);
+    if (flags & GRAPH_NODE_GOAL)
+        buffer.write(", shape=doublecircle", 20);
+    if (flags & GRAPH_NODE_DEAD_END)
+        buffer.write(", color=red", 11);
+    if (flags & GRAPH_NODE_PATH)
+        buffer.write(", style=filled, fillcolor=gold", 30);
+    buffer.write("];\n", 3);
+}
+
+// Escribe una arista en el formato elegido
+inline void write_graph_edge(OutputBuffer &buffer, GraphFormat format, size_t from, size_t to, bool on_path)
+{
+    if (format == GRAPH_BINARY)
+    {
+        buffer.put('E');
+        buffer.put_varint(from);
+        buffer.put_varint(to);
+        buffer.put(on_path ? 1 : 0);
+        return;
+    }
+
+    char line[100];
+    int length = snprintf(line, sizeof(line), "  s%llu -- s%llu%s;\n", (unsigned long long)from, (unsigned long long)to,
+                          on_path ? " [color=blue, penwidth=3]" : "");
+    buffer.write(line, length);
+}
+
+// Recorre todos los estados alcanzables desde el inicio y los escribe en out junto con sus aristas, solution es el camino
+// que se marca (puede estar vacío). Como todo viaje se puede deshacer regresando al mismo grupo, el grafo es no dirigido y
+// cada arista se escribe una sola vez, al expandir su estado con el bote en la izquierda. Los nodos se escriben al expandirlos,
+// cuando ya se conocen todos sus vecinos para saber si son un callejón sin salida
+inline GraphExportStats export_state_graph(ostream &out, GraphFormat format, int total_m, int total_c, int boat_capacity,
+                                           const vector<State> &solution)
+{
+    GraphExportStats stats = {0, 0, 0, 0};
+    OutputBuffer buffer(out);
+
+    vector<BoatLoad> moves = build_move_table(boat_capacity);
+    VisitedTable visited;
+    visited.reset(total_m, total_c);
+
+    // Posición de cada estado dentro del camino, para saber si una arista une 2 pasos consecutivos
+    unordered_map<uint64_t, size_t> path_position;
+    for (size_t i = 0; i < solution.size(); ++i)
+        path_position[solution[i].bits] = i;
+
+    if (format == GRAPH_BINARY)
+    {
+        buffer.write(GRAPH_BINARY_MAGIC, sizeof(GRAPH_BINARY_MAGIC));
+        uint32_t header[3] = {(uint32_t)total_m, (uint32_t)total_c, (uint32_t)boat_capacity};
+        buffer.write((const char *)header, sizeof(header));
+        uint64_t table_size = visited.size();
+        buffer.write((const char *)&table_size, sizeof(table_size));
+    }
+    else
+    {
+        char line[160];
+        int length = snprintf(line, sizeof(line), "graph mc_%d_%d_k%d {\n  node [shape=ellipse, fontsize=10];\n", total_m, total_c, boat_capacity);
+        buffer.write(line, length);
+    }
+
+    State initial_s = State::make(total_m, total_c, 0);
+    if (!is_valid(initial_s, total_m, total_c))
+    {
+        if (format == GRAPH_DOT)
+            buffer.write("}\n", 2);
+        buffer.flush_to_stream();
+        out.flush();
+        return stats;
+    }
+
+    // BFS por niveles, solo se guardan el nivel que se expande y el siguiente
+    vector<State> level(1, initial_s), next_level;
+    visited.set(visited.index(initial_s));
+    while (!level.empty())
+    {
+        stats.widest_level = max(stats.widest_level, level.size());
+        next_level.clear();
+        for (size_t j = 0; j < level.size(); ++j)
+        {
+            const State &current_s = level[j];
+            size_t current_index = visited.index(current_s);
+            auto current_on_path = path_position.find(current_s.bits);
+            int neighbors = 0;
+
+            for (size_t i = 0; i < moves.size(); ++i)
+            {
+                State next_s;
+                if (!apply_move(current_s, moves[i].m, moves[i].c, total_m, total_c, next_s) || !is_valid(next_s, total_m, total_c))
+                    continue;
+                neighbors++;
+                size_t next_index = visited.index(next_s);
+                if (!visited.test_and_set(next_index))
+                    next_level.push_back(next_s);
+
+                if (current_s.boat_pos() == 0)
+                {
+                    bool on_path = false;
+                    auto next_on_path = path_position.find(next_s.bits);
+                    if (current_on_path != path_position.end() && next_on_path != path_position.end())
+                        on_path = current_on_path->second + 1 == next_on_path->second || next_on_path->second + 1 == current_on_path->second;
+                    write_graph_edge(buffer, format, current_index, next_index, on_path);
+                    stats.edges++;
+                }
+            }
+
+            unsigned char flags = 0;
+            if (current_s == initial_s)
+                flags |= GRAPH_NODE_START;
+            if (is_solution(current_s, total_m, total_c))
+                flags |= GRAPH_NODE_GOAL;
+            else if (neighbors <= 1 && current_s != initial_s)
+            {
+                flags |= GRAPH_NODE_DEAD_END;
+                stats.dead_ends++;
+            }
+            if (current_on_path != path_position.end())
+                flags |= GRAPH_NODE_PATH;
+            write_graph_node(buffer, format, current_index, current_s, flags);
+            stats.nodes++;
+        }
+        level.swap(next_level);
+    }
+
+    if (format == GRAPH_DOT)
+        buffer.write("}\n", 2);
+    buffer.flush_to_stream();
+    out.flush();
+    return stats;
+}
+
+#endif
@@ -2,14 +2,37 @@
 #include <allegro5/allegro5.h>
 #include <allegro5/allegro_font.h>
 #include <allegro5/allegro_primitives.h>
+#include <allegro5/allegro_image.h>
+// Solucionador del problema
+#include "solver.h"
+// Cache de soluciones, para no volver a buscar problemas que ya se resolvieron
+#include "cache.h"
+// Escritura de los resultados en texto o binario
+#include "results_io.h"
+// Tiempos de los frames y traza para el panel de instrumentación
+#include "profiler.h"
+// Soluciones mas cortas alternativas, para recorrerlas con N y P
+#include "optimal_paths.h"
 // Librerías estándar de c++
 #include <iostream>
 #include <vector>
 #include <string>
-#include <sstream>
 #include <algorithm>
-#include <set>
 #include <fstream>
+#include <cstdlib>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cmath>
+#include <cstdio>
+#ifdef MC_DEBUG_ALLOCS
+#include <new>
+#include <cassert>
+#endif
 
 using namespace std;
 
@@ -21,249 +44,329 @@ const int screen_height = 600;
 enum CurrentPhase
 {
     KEYBOARD_INPUT,
+    SEARCHING, // Buscando la solución en otro hilo, se muestra "SOLVING..." con los estados explorados
     SOLVING,
     SOLVED,
     NO_SOLUTION
 };
 
-// Estructura para representar el estado del problema
-struct State
-{
-    // Misioneros y caníbales en izquierda
-    int m_left, c_left;
-    // Misioneros y caníbales en la derecha
-    int m_right, c_right;
-    // Declaramos la posición del bote con 0 para la izquierda y 1 para la derecha
-    int boat_pos;
-
-    /*
-    Dado que vamos a utilizar esta estructura en un set, necesitamos decirle como es que los debe de ordenar y
-    si la estructura esta repetida
-    */
-
-    // Sobrecargamos el operador ==, comparando con la otra estructura (estado2) y sus miembros, se utiliza
-    // el segundo const para asegurarnos de que en ningún momento se modifique algún valor (ya que solo estamos comparando),
-    // ver https://shorturl.at/73FC6
-    bool operator==(const State &state2) const
-    {
-        // Si en algún momento un miembro es distinto, se devolverá false y obviamente esto significara que
-        // las 2 estructuras no son iguales
-        return m_left == state2.m_left && c_left == state2.c_left &&
-               m_right == state2.m_right && c_right == state2.c_right &&
-               boat_pos == state2.boat_pos;
-    }
-
-    // Volvemos a hacer la sobrecarga pero ahora para el operador <, para que set sepa cual estructura va antes que la otra
-    bool operator<(const State &state2) const
-    {
-        // La comparación se hace con cada uno de los miembros de ambas estructuras
-        if (m_left != state2.m_left)
-            return m_left < state2.m_left;
-        if (c_left != state2.c_left)
-            return c_left < state2.c_left;
-        if (m_right != state2.m_right)
-            return m_right < state2.m_right;
-        if (c_right != state2.c_right)
-            return c_right < state2.c_right;
-        return boat_pos < state2.boat_pos;
-    }
+// Llamadas de dibujo a allegro en el frame actual, se reinicia antes de dibujar cada frame y la muestra el panel de
+// instrumentación (F3), un lote de bitmaps retenidos (al_hold_bitmap_drawing) cuenta como una sola llamada
+int frame_draw_calls = 0;
+
+// Colores de la simulación, se convierten una sola vez al iniciar (init_palette) en lugar de llamar a al_map_rgb por cada
+// elemento en cada frame
+struct Palette
+{
+    ALLEGRO_COLOR black, white, transparent;
+    ALLEGRO_COLOR missionary, cannibal, boat, shore, river;
+    // Textos: información, ayudas, el campo o aviso resaltado, éxito y error
+    ALLEGRO_COLOR info_text, hint_text, highlight, success, error;
+    // Barra de la reproducción y panel de instrumentación
+    ALLEGRO_COLOR bar_background, bar_fill, profiler_text, overlay_background;
 };
 
-// La capacidad del bote para el problema es de 2
-const int BOAT_CAPACITY = 2;
+Palette palette;
 
-// Esta es la verificación mas importante, ya que a medida que vamos resolviendo el problema se utilizara para ver si
-// vamos por buen camino o si se ha cometido algún error
-bool is_valid(const State &s, int total_m, int total_c)
+// Llena la paleta, se llama una vez después de al_init
+void init_palette()
 {
-    // Comprueba números negativos
-    if (s.m_left < 0 || s.c_left < 0 || s.m_right < 0 || s.c_right < 0)
-        return false;
+    palette.black = al_map_rgb(0, 0, 0);
+    palette.white = al_map_rgb(255, 255, 255);
+    palette.transparent = al_map_rgba(0, 0, 0, 0);
+    palette.missionary = al_map_rgb(0, 0, 255); // Azul para los Misioneros
+    palette.cannibal = al_map_rgb(255, 0, 0);   // Rojo para los Caníbales
+    palette.boat = al_map_rgb(139, 69, 19);     // Marrón para el Bote
+    palette.shore = al_map_rgb(34, 139, 34);    // Verde para las orillas
+    palette.river = al_map_rgb(0, 105, 148);    // Azul para el río
+    palette.info_text = al_map_rgb(200, 200, 200);
+    palette.hint_text = al_map_rgb(180, 180, 180);
+    palette.highlight = al_map_rgb(255, 255, 0);
+    palette.success = al_map_rgb(0, 255, 0);
+    palette.error = al_map_rgb(255, 0, 0);
+    palette.bar_background = al_map_rgb(60, 60, 60);
+    palette.bar_fill = al_map_rgb(0, 160, 220);
+    palette.profiler_text = al_map_rgb(0, 255, 128);
+    palette.overlay_background = al_map_rgba(0, 0, 0, 200);
+}
 
-    // Comprueba si los misioneros son superados en número en la orilla izquierda
-    if (s.m_left > 0 && s.m_left < s.c_left)
-        return false;
-    // Comprueba si los misioneros son superados en número en la orilla derecha
-    if (s.m_right > 0 && s.m_right < s.c_right)
-        return false;
+// Texto de la interfaz que solo se vuelve a formatear cuando cambia alguno de los valores que muestra, se guarda en un arreglo
+// fijo, asi mostrar el mismo texto frame tras frame no reserva memoria
+struct HudText
+{
+    char text[128];
+    long long values[5];
+    bool valid;
+};
 
-    // Si ninguna de estas condiciones es verdadera, significa que el estado actual
-    // del problema es valido
+// Devuelve true si el texto se tiene que volver a formatear porque alguno de los valores cambio (o aun no se formatea), y
+// guarda los valores nuevos
+bool hud_text_stale(HudText &hud, long long a, long long b = 0, long long c = 0, long long d = 0, long long e = 0)
+{
+    long long values[5] = {a, b, c, d, e};
+    if (hud.valid && equal(values, values + 5, hud.values))
+        return false;
+    copy(values, values + 5, hud.values);
+    hud.valid = true;
     return true;
 }
 
-// Función simple para comprobar si se ha resuelto el problema
-bool is_solution(const State &s, int total_m, int total_c)
+#ifdef MC_DEBUG_ALLOCS
+// Contador de reservas de memoria del hilo actual, al compilar con -DMC_DEBUG_ALLOCS se reemplaza el operator new global para
+// revisar que dibujar un frame estable no reserve memoria (los hilos de búsqueda y de escritura llevan su propia cuenta)
+thread_local long long debug_allocations = 0;
+
+void *operator new(size_t size)
 {
-    // Donde los misioneros, caníbales y el bote estén a la izquierda
-    return s.m_left == 0 && s.c_left == 0 && s.m_right == total_m && s.c_right == total_c && s.boat_pos == 1;
+    debug_allocations++;
+    void *memory = malloc(size ? size : 1);
+    if (!memory)
+        throw bad_alloc();
+    return memory;
 }
 
-// Función recursiva usando DFS
-bool solve_mc_recursive(State current_s, int total_m, int total_c, vector<State> &path, set<State> &visited)
+void operator delete(void *memory) noexcept
 {
-    // Lo primero que se hace es agregar al final de nuestro vector el estado actual
-    path.push_back(current_s);
-    // Agregamos el estado a nuestro set de estados visitados (recordar que no permite estructuras permitidas)
-    visited.insert(current_s);
+    free(memory);
+}
+#endif
 
-    // Verificamos si el estado actual es la solución al problema (caso base)
-    if (is_solution(current_s, total_m, total_c))
-    {
-        // Nuestra función devuelve verdadero
-        return true;
+// Igual que al_draw_text pero contando la llamada
+void draw_text(const ALLEGRO_FONT *font, ALLEGRO_COLOR color, float x, float y, int flags, const char *text)
+{
+    frame_draw_calls++;
+    al_draw_text(font, color, x, y, flags, text);
+}
+
+// Función para dibujar una persona individualmente, ya sea misionero o caníbal, en una posición específica y con un color dado
+void draw_person(float x, float y, ALLEGRO_COLOR color, bool is_missionary)
+{
+    // Dibuja un círculo relleno que representa el cuerpo de la persona
+    al_draw_filled_circle(x, y, 10, color); // Cuerpo de la persona, un círculo de radio 10
+    // Si la persona a dibujar es un misionero
+    if (is_missionary)
+    {                                                                                      // Para un misionero, se dibuja una especie de sombrero o una cruz simple
+        al_draw_line(x - 3, y - 12, x + 3, y - 12, palette.white, 2);          // Dibuja la línea horizontal del ala del sombrero
+        al_draw_filled_rectangle(x - 2, y - 15, x + 2, y - 12, palette.white); // Dibuja la parte superior rectangular del sombrero
     }
+    // Si no es misionero, entonces es un caníbal
+    else
+    {                                                                       // Para un caníbal, se dibujan dos líneas pequeñas como cuernos
+        al_draw_line(x - 3, y - 12, x - 1, y - 15, palette.black, 2); // Dibuja el cuerno izquierdo
+        al_draw_line(x + 3, y - 12, x + 1, y - 15, palette.black, 2); // Dibuja el cuerno derecho
+    }
+}
 
-    /* Exploramos los movimientos posibles*/
+// Tamaño de cada celda del atlas de sprites y posición dentro de la celda del punto (x, y) que draw_person toma como centro
+// de la persona, el sombrero y los cuernos llegan hasta y - 15 y el cuerpo hasta y + 10
+const int sprite_cell_width = 24;
+const int sprite_cell_height = 28;
+const float sprite_anchor_x = 12;
+const float sprite_anchor_y = 17;
+// Espacio horizontal entre cada persona y vertical entre la fila de misioneros y la de caníbales cuando se dibujan a tamaño
+// completo
+const float person_spacing = 25;
+const float person_row_spacing = 40;
+// Escala mínima de las personas, si para que quepan todas en la orilla tendrían que ser mas pequeñas ya no se distinguen, por
+// lo que en su lugar se dibuja una sola persona de cada tipo con el conteo a un lado
+const float min_person_scale = 0.2f;
+
+// Atlas con las figuras del misionero y del caníbal dibujadas una sola vez, la celda 0 es el misionero y la celda 1 el
+// caníbal, como todas las personas salen del mismo bitmap allegro puede juntar todas en un solo lote al dibujarlas
+struct SpriteAtlas
+{
+    ALLEGRO_BITMAP *bitmap;
+};
 
-    // Iteramos sobre el numero de misioneros que podrían ir en el bote (de 0 a BOAT_CAPACITY, que en este caso es 2)
-    for (int m_boat = 0; m_boat <= BOAT_CAPACITY; ++m_boat)
-    {
-        // Nuevamente iteramos sobre el numero de caníbales que podrían ir en el bote, haciendo una validación sobre el numero de
-        // caníbales que hay en el (c_boat <= BOAT_CAPACITY - m_boat), esto para asegurarnos de que no nos pasemos de la capacidad
-        // del bote
-        for (int c_boat = 0; c_boat <= BOAT_CAPACITY - m_boat; ++c_boat)
-        {
+// Dibuja las figuras de las personas en el atlas usando draw_person, se debe de llamar después de crear la pantalla para que
+// el atlas sea un bitmap de video
+bool create_sprite_atlas(SpriteAtlas &atlas)
+{
+    // Filtro lineal para que las figuras se vean bien al dibujarlas reducidas
+    int previous_flags = al_get_new_bitmap_flags();
+    al_set_new_bitmap_flags(previous_flags | ALLEGRO_MIN_LINEAR | ALLEGRO_MAG_LINEAR);
+    atlas.bitmap = al_create_bitmap(sprite_cell_width * 2, sprite_cell_height);
+    al_set_new_bitmap_flags(previous_flags);
+    if (!atlas.bitmap)
+        return false;
 
-            /*
-            Utilizamos los 2 for anidados para obtener todas las combinaciones posibles de misioneros y caníbales que pueden ir en el bote
-            respetando su capacidad
-            */
+    ALLEGRO_BITMAP *previous_target = al_get_target_bitmap();
+    al_set_target_bitmap(atlas.bitmap);
+    // Fondo transparente para que solo se vea la figura
+    al_clear_to_color(palette.transparent);
+    draw_person(sprite_anchor_x, sprite_anchor_y, palette.missionary, true);
+    draw_person(sprite_cell_width + sprite_anchor_x, sprite_anchor_y, palette.cannibal, false);
+    al_set_target_bitmap(previous_target);
+    return true;
+}
 
-            // Si tenemos el caso de que el bote este vació, simplemente ignoramos este y seguimos con la siguiente iteración
-            if (m_boat + c_boat == 0)
-            {
-                continue;
-            }
+void destroy_sprite_atlas(SpriteAtlas &atlas)
+{
+    if (atlas.bitmap)
+        al_destroy_bitmap(atlas.bitmap);
+    atlas.bitmap = nullptr;
+}
 
-            // Guardamos el estado actual del problema
-            State next_s = current_s;
+// Dibuja una persona del atlas con su centro en (x, y) y la escala dada, se debe de llamar con el dibujo de bitmaps retenido
+// (al_hold_bitmap_drawing) para que allegro mande todas las personas a la tarjeta de video de una vez
+void draw_person_sprite(const SpriteAtlas &atlas, float x, float y, bool is_missionary, float scale)
+{
+    float cell_x = is_missionary ? 0 : sprite_cell_width;
+    al_draw_scaled_bitmap(atlas.bitmap, cell_x, 0, sprite_cell_width, sprite_cell_height, x - sprite_anchor_x * scale, y - sprite_anchor_y * scale,
+                          sprite_cell_width * scale, sprite_cell_height * scale, 0);
+}
 
-            // Si el bote se encuentra del lado izquierdo
-            if (current_s.boat_pos == 0)
-            {
-                // Verificamos si el numero de misioneros y caníbales que vamos a probar (según los 2 for anidados) están disponibles
-                // del lado izquierdo
-                if (current_s.m_left >= m_boat && current_s.c_left >= c_boat)
-                {
-                    // De ser asi, entonces quitamos los misioneros y caníbales de la izquierda
-                    next_s.m_left -= m_boat;
-                    next_s.c_left -= c_boat;
-                    // Y agregamos esta misma cantidad al lado derecho, simulando que paso el bote
-                    next_s.m_right += m_boat;
-                    next_s.c_right += c_boat;
-                    // Cambiamos la posición del bote
-                    next_s.boat_pos = 1;
-                }
-                // Si no hay suficientes misioneros y/o caníbales para este movimiento, entonces lo ignoramos y seguimos con
-                // la siguiente iteración
-                else
-                {
-                    continue;
-                }
-            }
-            // Si el bote se encuentra del lado derecho
-            else
-            {
-                // Realizamos la misma verificación para ver si del lado derecho hay suficientes misioneros y caníbales
-                // disponibles para el movimiento
-                if (current_s.m_right >= m_boat && current_s.c_right >= c_boat)
-                {
-                    // Quitamos los misioneros y caníbales del lado derecho
-                    next_s.m_right -= m_boat;
-                    next_s.c_right -= c_boat;
-                    // Y los agregamos al otro lado
-                    next_s.m_left += m_boat;
-                    next_s.c_left += c_boat;
-                    // Cambiamos la posición del bote
-                    next_s.boat_pos = 0;
-                }
-                // Si no hay suficientes misioneros y/o caníbales para este movimiento, entonces lo ignoramos y seguimos con
-                // la siguiente iteración
-                else
-                {
-                    continue;
-                }
-            }
+// Calcula la escala mas grande (hasta 1) con la que count personas de cada tipo caben en un área de width por height, los
+// misioneros y caníbales van en filas alternadas, si la escala queda debajo de min_person_scale se usa el conteo agrupado
+float compute_person_scale(int count, float width, float height)
+{
+    float scale = 1.0f;
+    while (count > 0 && scale >= min_person_scale)
+    {
+        int columns = max(1, (int)(width / (person_spacing * scale)));
+        int row_pairs = (count + columns - 1) / columns;
+        if (row_pairs * 2 * person_row_spacing * scale <= height)
+            break;
+        scale *= 0.9f;
+    }
+    return scale;
+}
 
-            // Tras haber hecho el movimiento (ya sea de izquierda a derecha o de derecha a izquierda), verificamos si el el estado actual del problema es valido,
-            // ademas, buscamos si el estado actual ya ha sido visitado en el set y si lo encuentra, entonces devuelve un iterator apuntando a ese elemento, en caso
-            // contrario devuelve un .end()
-            if (is_valid(next_s, total_m, total_c) && visited.find(next_s) == visited.end())
-            {
-                // Si entramos al if es porque el estado actual del problema es valido y este no se encontró en el set, por lo que podemos seguir investigando las posibilidades
-                // de este estado (DFS) esperando encontrar la solución
-                if (solve_mc_recursive(next_s, total_m, total_c, path, visited))
-                {
-                    // Si esta función devuelve verdadero, entonces se ha encontrado la solución al problema, y retornando true propagamos como una señal de "solución encontrada"
-                    // hacia arriba en la cadena de llamadas recursivas
-                    return true;
-                }
-            }
+// Dibuja las personas de una orilla a partir de (x, y), en una cuadricula que se corta al llegar a width, o agrupadas (una
+// figura de cada tipo con su conteo) si la escala es demasiado pequeña para distinguirlas
+void draw_shore_people(const SpriteAtlas &atlas, ALLEGRO_FONT *font, float x, float y, float width, float scale, int missionaries, int cannibals)
+{
+    if (scale < min_person_scale)
+    {
+        // El conteo se formatea en un arreglo en la pila, al_draw_textf reservaría memoria en cada llamada
+        char count_text[32];
+        if (missionaries > 0)
+        {
+            draw_person_sprite(atlas, x, y, true, 1.0f);
+            frame_draw_calls++;
+            snprintf(count_text, sizeof(count_text), "x %d", missionaries);
+            draw_text(font, palette.white, x + person_spacing, y - 4, ALLEGRO_ALIGN_LEFT, count_text);
+        }
+        if (cannibals > 0)
+        {
+            draw_person_sprite(atlas, x, y + person_row_spacing, false, 1.0f);
+            frame_draw_calls++;
+            snprintf(count_text, sizeof(count_text), "x %d", cannibals);
+            draw_text(font, palette.white, x + person_spacing, y + person_row_spacing - 4, ALLEGRO_ALIGN_LEFT, count_text);
         }
+        return;
     }
 
-    // Si llegamos a este punto, es porque durante la exploración de movimientos posibles, no se encontró ningún estado del problema valido, por lo que quitamos
-    // este estado de nuestro vector
-    path.pop_back();
-    // Dado que no se resolvió y ni se encontró posibles caminos a soluciones, devolvemos false
-    return false;
+    // Con escala 1 y pocas personas queda una sola fila de misioneros y debajo una de caníbales, igual que antes
+    int columns = max(1, (int)(width / (person_spacing * scale)));
+    for (int i = 0; i < missionaries; ++i)
+        draw_person_sprite(atlas, x + (i % columns) * person_spacing * scale, y + (i / columns) * 2 * person_row_spacing * scale, true, scale);
+    for (int i = 0; i < cannibals; ++i)
+        draw_person_sprite(atlas, x + (i % columns) * person_spacing * scale, y + ((i / columns) * 2 + 1) * person_row_spacing * scale, false, scale);
 }
 
-// Esta es la función principal la cual se va a encargar de solucionar el problema (si es que hay solución de este)
-bool solve_mc(int initial_m, int initial_c, vector<State> &path)
+// Dimensiones y posiciones relativas de las orillas y el río en la pantalla, las usan tanto el fondo estático como las partes
+// que se mueven, por lo que se calculan en un solo lugar
+struct SceneLayout
 {
-    // Declaramos un set que trabaja con la estructura State
-    set<State> visited;
-    // Creamos una estructura inicial con el numero de misioneros y caníbales a trabajar (todos del lado izquierdo) y aparte
-    // la posición del bote que esta del lado izquierdo
-    State initial_state = {initial_m, initial_c, 0, 0, 0};
+    float shore_width;   // Cada orilla ocupa un 25% del ancho de la pantalla
+    float river_width;   // El río ocupa el 50% central del ancho de la pantalla
+    float shore_y_start; // Posición Y donde comienzan a dibujarse las orillas y el río
+    float shore_height;  // Altura de las orillas y el río
+};
 
-    // Antes de empezar a resolverlo, debemos de verificar si el problema se puede resolver con estos datos, para este momento,
-    // simplemente se hace para ver si los misioneros pierden en numero contra los caníbales (lo cual no es un estado inicial
-    // valido)
-    if (!is_valid(initial_state, initial_m, initial_c))
-        // De ser asi entonces ni siquiera podemos resolver el problema
-        return false;
+SceneLayout make_scene_layout()
+{
+    SceneLayout layout = {screen_width * 0.25f, screen_width * 0.5f, screen_height * 0.4f, screen_height * 0.5f};
+    return layout;
+}
 
-    // Si el problema es valido desde el inicio, entonces ya podemos resolver el problema
-    return solve_mc_recursive(initial_state, initial_m, initial_c, path, visited);
+// Fondo estático de la simulación (orillas, río y textos que no cambian durante la animación) dibujado una sola vez en un
+// bitmap fuera de pantalla, asi en cada frame basta con copiar este bitmap y dibujar encima solo lo que se mueve
+struct SceneCache
+{
+    ALLEGRO_BITMAP *background;
+    // Tamaño de la ventana y totales con los que se dibujo el fondo, si cambian se vuelve a dibujar
+    int width, height;
+    int total_m, total_c;
+    // Textos con los conteos de cada orilla, cambian solo cuando alguien cruza
+    HudText left_shore_text, right_shore_text;
+};
+
+// Libera el bitmap del fondo (se debe de llamar antes de destruir la pantalla)
+void destroy_scene_cache(SceneCache &cache)
+{
+    if (cache.background)
+        al_destroy_bitmap(cache.background);
+    cache.background = nullptr;
 }
 
-// Función para dibujar una persona individualmente, ya sea misionero o caníbal, en una posición específica y con un color dado
-void draw_person(float x, float y, ALLEGRO_COLOR color, bool is_missionary)
+// Devuelve el fondo estático para el tamaño de ventana y los totales dados, dibujándolo solo si aun no existe o si alguno de
+// estos valores cambio desde la ultima vez, o nullptr si no se pudo crear el bitmap
+ALLEGRO_BITMAP *get_static_scene(SceneCache &cache, int width, int height, int total_m, int total_c, ALLEGRO_FONT *font)
 {
-    // Dibuja un círculo relleno que representa el cuerpo de la persona
-    al_draw_filled_circle(x, y, 10, color); // Cuerpo de la persona, un círculo de radio 10
-    // Si la persona a dibujar es un misionero
-    if (is_missionary)
-    {                                                                                      // Para un misionero, se dibuja una especie de sombrero o una cruz simple
-        al_draw_line(x - 3, y - 12, x + 3, y - 12, al_map_rgb(255, 255, 255), 2);          // Dibuja la línea horizontal del ala del sombrero
-        al_draw_filled_rectangle(x - 2, y - 15, x + 2, y - 12, al_map_rgb(255, 255, 255)); // Dibuja la parte superior rectangular del sombrero
-    }
-    // Si no es misionero, entonces es un caníbal
-    else
-    {                                                                       // Para un caníbal, se dibujan dos líneas pequeñas como cuernos
-        al_draw_line(x - 3, y - 12, x - 1, y - 15, al_map_rgb(0, 0, 0), 2); // Dibuja el cuerno izquierdo
-        al_draw_line(x + 3, y - 12, x + 1, y - 15, al_map_rgb(0, 0, 0), 2); // Dibuja el cuerno derecho
-    }
+    if (cache.background && cache.width == width && cache.height == height && cache.total_m == total_m && cache.total_c == total_c)
+        return cache.background;
+
+    // Si el tamaño cambio creamos un bitmap nuevo, si solo cambiaron los totales reutilizamos el que ya teníamos
+    if (cache.background && (cache.width != width || cache.height != height))
+        destroy_scene_cache(cache);
+    if (!cache.background)
+        cache.background = al_create_bitmap(width, height);
+    if (!cache.background)
+        return nullptr;
+    cache.width = width;
+    cache.height = height;
+    cache.total_m = total_m;
+    cache.total_c = total_c;
+
+    SceneLayout layout = make_scene_layout();
+    float shore_width = layout.shore_width;
+    float river_width = layout.river_width;
+    float shore_y_start = layout.shore_y_start;
+    float shore_height = layout.shore_height;
+
+    // Dibujamos sobre el bitmap en lugar de la pantalla, guardando el destino actual para regresar a el al terminar
+    ALLEGRO_BITMAP *previous_target = al_get_target_bitmap();
+    al_set_target_bitmap(cache.background);
+
+    // Fondo negro, igual que el resto de la pantalla
+    al_clear_to_color(palette.black);
+
+    // Dibujar la orilla izquierda como un rectángulo relleno
+    al_draw_filled_rectangle(0, shore_y_start, shore_width, shore_y_start + shore_height, palette.shore);
+    // Dibujar la orilla derecha como un rectángulo relleno
+    al_draw_filled_rectangle(shore_width + river_width, shore_y_start, screen_width, shore_y_start + shore_height, palette.shore);
+
+    // Dibujar el río como un rectángulo relleno entre las dos orillas
+    al_draw_filled_rectangle(shore_width, shore_y_start, shore_width + river_width, shore_y_start + shore_height, palette.river);
+
+    // Mostrar los conteos totales iniciales de misioneros y caníbales como referencia en la esquina superior derecha
+    char total_counts_text[64];
+    snprintf(total_counts_text, sizeof(total_counts_text), "Total M: %d, Total C: %d", total_m, total_c);
+    draw_text(font, palette.info_text, screen_width - 10, 10, ALLEGRO_ALIGN_RIGHT, total_counts_text);
+
+    al_set_target_bitmap(previous_target);
+    return cache.background;
 }
 
-// Función principal para dibujar el programa
-void draw_state(const State &current_s, const State *ptr_prev_s, int total_initial_m, int total_initial_c, ALLEGRO_FONT *font, float boat_anim_progress)
+// Función principal para dibujar el programa, el fondo estático sale de scene y encima se dibujan el bote, las personas y
+// los conteos de cada orilla
+void draw_state(const State &packed_s, const State *ptr_prev_s, int total_initial_m, int total_initial_c, ALLEGRO_FONT *font, float boat_anim_progress,
+                SceneCache &scene, const SpriteAtlas &atlas)
 {
-    // Definimos los colores que se utilizarán para los distintos elementos de la simulación
-    ALLEGRO_COLOR missionary_color = al_map_rgb(0, 0, 255); // Azul para los Misioneros
-    ALLEGRO_COLOR cannibal_color = al_map_rgb(255, 0, 0);   // Rojo para los Caníbales
-    ALLEGRO_COLOR boat_color = al_map_rgb(139, 69, 19);    // Marrón para el Bote
-    ALLEGRO_COLOR water_color = al_map_rgb(0, 105, 148);    // Azul oscuro para el Agua del río
-    ALLEGRO_COLOR shore_color = al_map_rgb(34, 139, 34);  // Verde para las Orillas
+    // Desempaquetamos el estado a dibujar para leer con comodidad ambas orillas
+    StateView current_s = packed_s.view(total_initial_m, total_initial_c);
+
+    // Color del bote, sale de la paleta (los colores de los misioneros y caníbales ya están en el atlas de sprites)
+    ALLEGRO_COLOR boat_color = palette.boat;
 
-    // Definimos las dimensiones y posiciones relativas de las orillas y el río en la pantalla
-    float shore_width = screen_width * 0.25f;  // Cada orilla ocupa un 25% del ancho de la pantalla
-    float river_width = screen_width * 0.5f;      // El río ocupa el 50% central del ancho de la pantalla
-    float shore_y_start = screen_height * 0.4f; // Posición Y donde comienzan a dibujarse las orillas y el río
-    float shore_height = screen_height * 0.5f;     // Altura de las orillas y el río
+    // Tomamos las dimensiones y posiciones relativas de las orillas y el río en la pantalla
+    SceneLayout layout = make_scene_layout();
+    float shore_width = layout.shore_width;
+    float river_width = layout.river_width;
+    float shore_y_start = layout.shore_y_start;
+    float shore_height = layout.shore_height;
 
     // Inicializamos los contadores de misioneros y caníbales en cada orilla basándonos en el estado actual
     int m_on_left_shore = current_s.m_left;
@@ -311,7 +414,7 @@ void draw_state(const State &current_s, const State *ptr_prev_s, int total_initi
     if (ptr_prev_s && boat_anim_progress > 0.0f && boat_anim_progress < 1.0f)
     {
         // El bote está actualmente moviéndose entre orillas
-        const State &prev_s = *ptr_prev_s; // Referencia al estado anterior para comparaciones
+        StateView prev_s = ptr_prev_s->view(total_initial_m, total_initial_c); // Estado anterior desempaquetado para comparaciones
 
         // Si el bote en el estado previo estaba en la orilla izquierda (0)
         if (prev_s.boat_pos == 0)
@@ -356,47 +459,37 @@ void draw_state(const State &current_s, const State *ptr_prev_s, int total_initi
 
     // --- Comienza el dibujo de los elementos ---
 
-    // Dibujar la orilla izquierda como un rectángulo relleno
-    al_draw_filled_rectangle(0, shore_y_start, shore_width, shore_y_start + shore_height, shore_color);
-    // Dibujar la orilla derecha como un rectángulo relleno
-    al_draw_filled_rectangle(shore_width + river_width, shore_y_start, screen_width, shore_y_start + shore_height, shore_color);
-
-    // Dibujar el río como un rectángulo relleno entre las dos orillas
-    al_draw_filled_rectangle(shore_width, shore_y_start, shore_width + river_width, shore_y_start + shore_height, water_color);
-
-    // Dibujar las personas en la orilla izquierda
-    float person_x_start_left = shore_width * 0.1f; // Posición X inicial para la primera persona en la orilla izquierda
-    float person_y_start = shore_y_start + 30;          // Posición Y inicial para la fila de misioneros
-    float person_spacing = 25;                           // Espacio horizontal entre cada persona
-
-    // Bucle para dibujar cada misionero en la orilla izquierda
-    for (int i = 0; i < m_on_left_shore; ++i)
-    {
-        draw_person(person_x_start_left + i * person_spacing, person_y_start, missionary_color, true);
-    }
-    // Bucle para dibujar cada caníbal en la orilla izquierda, en una fila debajo de los misioneros
-    for (int i = 0; i < c_on_left_shore; ++i)
+    // Copiamos el fondo estático (orillas, río y totales), que solo se vuelve a dibujar si cambia el tamaño de la ventana o
+    // los totales, en lugar de dibujar cada rectángulo en cada frame
+    ALLEGRO_BITMAP *target = al_get_target_bitmap();
+    ALLEGRO_BITMAP *background = get_static_scene(scene, al_get_bitmap_width(target), al_get_bitmap_height(target), total_initial_m, total_initial_c, font);
+    if (background)
     {
-        draw_person(person_x_start_left + i * person_spacing, person_y_start + 40, cannibal_color, false);
+        frame_draw_calls++;
+        al_draw_bitmap(background, 0, 0, 0);
     }
 
-    // Dibujar las personas en la orilla derecha
+    // Las personas de las orillas se dibujan en una cuadricula dentro de cada orilla, la escala depende del total de personas
+    // (que no cambia durante la animación) para que las figuras no cambien de tamaño cuando alguien cruza el río
+    float person_x_start_left = shore_width * 0.1f;                               // Posición X inicial para la primera persona en la orilla izquierda
     float person_x_start_right = shore_width + river_width + shore_width * 0.1f; // Posición X inicial para la primera persona en la orilla derecha
-    // Bucle para dibujar cada misionero en la orilla derecha
-    for (int i = 0; i < m_on_right_shore; ++i)
-    {
-        draw_person(person_x_start_right + i * person_spacing, person_y_start, missionary_color, true);
-    }
-    // Bucle para dibujar cada caníbal en la orilla derecha, en una fila debajo de los misioneros
-    for (int i = 0; i < c_on_right_shore; ++i)
-    {
-        draw_person(person_x_start_right + i * person_spacing, person_y_start + 40, cannibal_color, false);
-    }
+    float person_y_start = shore_y_start + 30;                                    // Posición Y inicial para la fila de misioneros
+    float people_area_width = shore_width * 0.8f;
+    float people_area_height = shore_y_start + shore_height - person_y_start - 10;
+    float shore_scale = compute_person_scale(max(total_initial_m, total_initial_c), people_area_width, people_area_height);
+
+    // Retenemos el dibujo de bitmaps para que todas las personas de ambas orillas se manden juntas en un solo lote
+    al_hold_bitmap_drawing(true);
+    draw_shore_people(atlas, font, person_x_start_left, person_y_start, people_area_width, shore_scale, m_on_left_shore, c_on_left_shore);
+    draw_shore_people(atlas, font, person_x_start_right, person_y_start, people_area_width, shore_scale, m_on_right_shore, c_on_right_shore);
+    al_hold_bitmap_drawing(false);
+    frame_draw_calls++;
 
     // Dibujar el Bote en su posición X actual calculada (current_boat_draw_x)
     al_draw_filled_rectangle(current_boat_draw_x, boat_y, current_boat_draw_x + boat_width, boat_y + boat_height, boat_color);
     // Dibujar un contorno negro alrededor del bote para mejor visibilidad
-    al_draw_rectangle(current_boat_draw_x, boat_y, current_boat_draw_x + boat_width, boat_y + boat_height, al_map_rgb(0, 0, 0), 2);
+    al_draw_rectangle(current_boat_draw_x, boat_y, current_boat_draw_x + boat_width, boat_y + boat_height, palette.black, 2);
+    frame_draw_calls += 2;
 
     // Dibujar las personas que están actualmente en el bote
     if (m_in_boat > 0 || c_in_boat > 0)
@@ -407,42 +500,727 @@ void draw_state(const State &current_s, const State *ptr_prev_s, int total_initi
         int total_in_boat = m_in_boat + c_in_boat;
         // Calculamos el espaciado horizontal entre personas dentro del bote
         float boat_person_x_spacing = boat_width / (total_in_boat + 1);
-        int person_idx_in_boat = 0; // Índice para posicionar secuencialmente a las personas en el bote
-        // Bucle para dibujar a los misioneros en el bote
-        for (int i = 0; i < m_in_boat; ++i)
-        {
-            draw_person(current_boat_draw_x + boat_person_x_spacing * (person_idx_in_boat + 1), boat_y + boat_person_y_offset, missionary_color, true);
-            person_idx_in_boat++; // Incrementar índice para la siguiente persona
-        }
-        // Bucle para dibujar a los caníbales en el bote
-        for (int i = 0; i < c_in_boat; ++i)
+        // Con botes grandes reducimos las figuras para que no se encimen
+        float boat_scale = min(1.0f, boat_person_x_spacing / person_spacing * 1.5f);
+        al_hold_bitmap_drawing(true);
+        // Primero los misioneros y después los caníbales, cada uno en su lugar del bote
+        for (int i = 0; i < total_in_boat; ++i)
         {
-            draw_person(current_boat_draw_x + boat_person_x_spacing * (person_idx_in_boat + 1), boat_y + boat_person_y_offset, cannibal_color, false);
-            person_idx_in_boat++; // Incrementar índice para la siguiente persona
+            draw_person_sprite(atlas, current_boat_draw_x + boat_person_x_spacing * (i + 1), boat_y + boat_person_y_offset, i < m_in_boat, boat_scale);
         }
+        al_hold_bitmap_drawing(false);
+        frame_draw_calls++;
     }
 
-    // Mostrar los conteos de misioneros y caníbales en cada orilla usando texto
-    stringstream left_shore_text, right_shore_text; // Stringstreams para formatear el texto de los conteos
+    // Mostrar los conteos de misioneros y caníbales en cada orilla usando texto, que solo se vuelve a formatear cuando cambian
     // Formatear texto para la orilla izquierda usando los valores de current_s (reflejan el estado final del movimiento si está atracado)
-    left_shore_text << "Left Shore: M=" << current_s.m_left << ", C=" << current_s.c_left;
+    if (hud_text_stale(scene.left_shore_text, current_s.m_left, current_s.c_left))
+        snprintf(scene.left_shore_text.text, sizeof(scene.left_shore_text.text), "Left Shore: M=%d, C=%d", current_s.m_left, current_s.c_left);
     // Formatear texto para la orilla derecha usando los valores de current_s
-    right_shore_text << "Right Shore: M=" << current_s.m_right << ", C=" << current_s.c_right;
+    if (hud_text_stale(scene.right_shore_text, current_s.m_right, current_s.c_right))
+        snprintf(scene.right_shore_text.text, sizeof(scene.right_shore_text.text), "Right Shore: M=%d, C=%d", current_s.m_right, current_s.c_right);
     // El contenido del bote se dibuja visualmente, el texto del bote podría ser redundante o complejo si se muestra siempre
 
     // Dibujar el texto del conteo para la orilla izquierda, centrado sobre la orilla
-    al_draw_text(font, al_map_rgb(255, 255, 255), shore_width / 2, shore_y_start - 60, ALLEGRO_ALIGN_CENTRE, left_shore_text.str().c_str());
+    draw_text(font, palette.white, shore_width / 2, shore_y_start - 60, ALLEGRO_ALIGN_CENTRE, scene.left_shore_text.text);
     // Dibujar el texto del conteo para la orilla derecha, centrado sobre la orilla
-    al_draw_text(font, al_map_rgb(255, 255, 255), shore_width + river_width + shore_width / 2, shore_y_start - 60, ALLEGRO_ALIGN_CENTRE, right_shore_text.str().c_str());
+    draw_text(font, palette.white, shore_width + river_width + shore_width / 2, shore_y_start - 60, ALLEGRO_ALIGN_CENTRE, scene.right_shore_text.text);
+}
 
-    // Mostrar los conteos totales iniciales de misioneros y caníbales como referencia en la esquina superior derecha
-    stringstream total_counts_text;
-    total_counts_text << "Total M: " << total_initial_m << ", Total C: " << total_initial_c;
-    al_draw_text(font, al_map_rgb(200, 200, 200), screen_width - 10, 10, ALLEGRO_ALIGN_RIGHT, total_counts_text.str().c_str());
+// Resolución que corre en un hilo aparte, asi el ciclo de eventos sigue respondiendo (y dibujando el progreso) mientras se
+// busca la solución, sin importar que tan grande sea el problema
+struct BackgroundSolve
+{
+    thread worker;
+    // Progreso y cancelación compartidos con el hilo que resuelve
+    SolveControl control;
+    // Se pone en true cuando el hilo ya dejo listos path, stats y solved
+    atomic<bool> done;
+    // Resultado de la búsqueda, solo se deben de leer después de que done sea true
+    vector<State> path;
+    SolveStats stats;
+    bool solved;
+    // Cuando empezó y termino la resolución, para el panel de instrumentación y la traza
+    chrono::steady_clock::time_point started, finished;
+
+    BackgroundSolve() : done(false), solved(false) {}
+};
+
+// Empieza a resolver el problema en otro hilo
+void start_background_solve(BackgroundSolve &job, int total_m, int total_c, int boat_capacity, SolverAlgorithm algorithm)
+{
+    job.control.cancel.store(false);
+    job.control.states_explored.store(0);
+    job.done.store(false);
+    job.path.clear();
+    job.solved = false;
+
+    job.worker = thread([&job, total_m, total_c, boat_capacity, algorithm]() {
+        job.started = chrono::steady_clock::now();
+        job.solved = solve_mc(total_m, total_c, boat_capacity, job.path, algorithm, &job.stats, nullptr, &job.control);
+        job.finished = chrono::steady_clock::now();
+        // Avisamos al ciclo de eventos que ya puede tomar el resultado
+        job.done.store(true);
+    });
+}
+
+// Escritura del archivo de resultados en otro hilo, para que guardar un camino muy largo no detenga la animación
+struct ResultsWriter
+{
+    thread worker;
+    // Copia del camino que se esta escribiendo, asi la simulación puede limpiar o reemplazar el suyo mientras tanto
+    vector<State> path;
+    // Se pone en true cuando el archivo ya se termino de escribir
+    atomic<bool> done;
+
+    ResultsWriter() : done(true) {}
+};
+
+// Espera a que se termine de escribir el archivo (si se estaba escribiendo)
+void finish_results_write(ResultsWriter &writer)
+{
+    if (writer.worker.joinable())
+        writer.worker.join();
+}
+
+// Empieza a escribir el archivo de resultados en el formato dado en otro hilo
+void start_results_write(ResultsWriter &writer, ResultsFormat format, const vector<State> &path, int total_m, int total_c, int boat_capacity)
+{
+    // Si aun se esta escribiendo el archivo anterior esperamos a que termine antes de volver a abrirlo
+    finish_results_write(writer);
+    writer.path = path;
+    writer.done.store(false);
+
+    writer.worker = thread([&writer, format, total_m, total_c, boat_capacity]() {
+        // Abrimos el archivo resultados, y si este no existe, entonces lo creamos
+        const char *file_name = results_file_name(format);
+        ofstream results_file(file_name, format == RESULTS_BINARY ? ios::out | ios::binary : ios::out);
+
+        // Verificamos si este se abrio correctamente
+        if (results_file.is_open())
+            // Imprimimos en este archivo la información del problema y cada paso de la solución
+            write_results_as(format, results_file, writer.path, total_m, total_c, boat_capacity);
+        else
+            // cerr se utiliza como un cout pero este esta especializado para mandar mensajes de errores en stderr, ademas
+            // de que este no se guarda en buffer y se muestra inmediatamente
+            cerr << "Error: Could not open " << file_name << " to save the results." << endl;
+        writer.done.store(true);
+    });
+}
+
+// Empieza a resolver el problema, si ya esta en el cache copia el resultado a path y stats y devuelve la fase a la que se
+// pasa directamente (SOLVING o NO_SOLUTION), si no, lo empieza a resolver en otro hilo y devuelve SEARCHING
+CurrentPhase begin_solve(SolutionCache &cache, BackgroundSolve &job, int total_m, int total_c, int boat_capacity, SolverAlgorithm algorithm,
+                         vector<State> &path, SolveStats &stats)
+{
+    SolveKey key = {total_m, total_c, boat_capacity, algorithm};
+    CachedSolution cached;
+    if (cache.lookup(key, cached))
+    {
+        path.swap(cached.path);
+        stats.states_expanded = cached.states_expanded;
+        return cached.solved ? SOLVING : NO_SOLUTION;
+    }
+
+    start_background_solve(job, total_m, total_c, boat_capacity, algorithm);
+    return SEARCHING;
+}
+
+// Pide al hilo que deje de buscar y espera a que termine, como la búsqueda revisa la cancelación seguido, esto es inmediato
+void cancel_background_solve(BackgroundSolve &job)
+{
+    if (job.worker.joinable())
+    {
+        job.control.cancel.store(true);
+        job.worker.join();
+    }
+}
+
+// Trabajo de la vista previa del menu por frame, en movimientos probados por A* (unos pocos milisegundos)
+const long long menu_preview_work = 1 << 20;
+// Limite de problemas guardados en la tabla de la vista previa, al pasarlo solo se quedan el problema mostrado y sus vecinos
+const size_t menu_preview_max_known = 4096;
+
+// Vista previa del menu: si el problema elegido tiene solución y cuantos movimientos tiene la mas corta, se actualiza mientras
+// se cambian los valores con las flechas. Si tiene solución se sabe al instante con is_solvable, los movimientos se buscan con
+// A* en el hilo principal avanzando un poco en cada frame, y cada resultado se guarda en una tabla indexada por los totales.
+// Las flechas solo cambian un valor en 1, por eso al terminar el problema mostrado se siguen buscando sus vecinos (un
+// misionero, un caníbal o un lugar del bote mas o menos), asi al presionar una flecha el resultado casi siempre ya esta en la
+// tabla y se muestra en el mismo frame
+struct MenuPreview
+{
+    // Problema que se esta mostrando
+    int total_m, total_c, boat_capacity;
+    bool solvable;
+    // Movimientos de la solución mas corta, -1 mientras se buscan
+    long long moves;
+    // Búsqueda en curso (del problema mostrado o de un vecino), conserva su memoria entre un problema y otro
+    AStarSearch search;
+    SolveKey search_key;
+    bool searching;
+    // Problemas que faltan por buscar, el siguiente es el del final
+    vector<SolveKey> pending;
+    // Movimientos de los problemas que ya se buscaron (-1 si no tienen solución), como máximo menu_preview_max_known
+    unordered_map<SolveKey, long long, SolveKeyHash> known_moves;
+};
+
+// Empieza la siguiente búsqueda pendiente que aun no este en la tabla, los problemas sin solución se guardan directamente
+void start_next_preview_search(MenuPreview &preview)
+{
+    preview.searching = false;
+    while (!preview.pending.empty())
+    {
+        SolveKey key = preview.pending.back();
+        preview.pending.pop_back();
+        if (preview.known_moves.count(key))
+            continue;
+        if (!is_valid(State::make(key.missionaries, key.cannibals, 0), key.missionaries, key.cannibals) ||
+            !is_solvable(key.missionaries, key.cannibals, key.boat_capacity))
+        {
+            preview.known_moves[key] = -1;
+            continue;
+        }
+        preview.search.start(State::make(key.missionaries, key.cannibals, 0), key.missionaries, key.cannibals, key.boat_capacity);
+        preview.search_key = key;
+        preview.searching = true;
+        return;
+    }
+}
+
+// Avanza la búsqueda de la vista previa con el trabajo de un frame, y al terminar guarda el resultado en la tabla y sigue
+// con la siguiente pendiente
+void step_menu_preview(MenuPreview &preview)
+{
+    long long budget = max(1LL, menu_preview_work / (long long)max((size_t)1, preview.search.moves.size()));
+    SearchStatus status = preview.search.step(budget);
+    if (status == SEARCH_RUNNING)
+        return;
+
+    long long moves = status == SEARCH_FOUND ? preview.search.best_g[preview.search.closed.index(preview.search.goal)] : -1;
+    preview.known_moves[preview.search_key] = moves;
+    const SolveKey &key = preview.search_key;
+    if (key.missionaries == preview.total_m && key.cannibals == preview.total_c && key.boat_capacity == preview.boat_capacity)
+    {
+        preview.moves = moves;
+        preview.solvable = moves >= 0;
+    }
+    start_next_preview_search(preview);
+}
+
+// Se llama en cada frame del menu con los valores elegidos, si cambiaron muestra el nuevo problema (de la tabla si ya se
+// busco) y prepara las búsquedas del problema y de sus vecinos, y si no, sigue con la búsqueda pendiente
+void update_menu_preview(MenuPreview &preview, int total_m, int total_c, int boat_capacity)
+{
+    if (total_m == preview.total_m && total_c == preview.total_c && boat_capacity == preview.boat_capacity)
+    {
+        if (preview.searching)
+            step_menu_preview(preview);
+        return;
+    }
+
+    preview.total_m = total_m;
+    preview.total_c = total_c;
+    preview.boat_capacity = boat_capacity;
+    preview.moves = -1;
+    preview.solvable = is_valid(State::make(total_m, total_c, 0), total_m, total_c) && is_solvable(total_m, total_c, boat_capacity);
+
+    // Si la tabla ya esta llena se descartan los problemas lejanos, los que quedan a un paso de una flecha se siguen usando
+    if (preview.known_moves.size() > menu_preview_max_known)
+    {
+        for (auto it = preview.known_moves.begin(); it != preview.known_moves.end();)
+        {
+            const SolveKey &k = it->first;
+            int distance = abs(k.missionaries - total_m) + abs(k.cannibals - total_c) + abs(k.boat_capacity - boat_capacity);
+            if (distance > 1)
+                it = preview.known_moves.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    SolveKey key = {total_m, total_c, boat_capacity, ALGORITHM_ASTAR};
+    auto found = preview.known_moves.find(key);
+    bool known = found != preview.known_moves.end();
+    if (known)
+        preview.moves = found->second;
+
+    // Primero se busca el problema mostrado (si hace falta) y después sus vecinos que aun no se conocen
+    SolveKey neighbors[6] = {{total_m + 1, total_c, boat_capacity, ALGORITHM_ASTAR}, {total_m - 1, total_c, boat_capacity, ALGORITHM_ASTAR},
+                             {total_m, total_c + 1, boat_capacity, ALGORITHM_ASTAR}, {total_m, total_c - 1, boat_capacity, ALGORITHM_ASTAR},
+                             {total_m, total_c, boat_capacity + 1, ALGORITHM_ASTAR}, {total_m, total_c, boat_capacity - 1, ALGORITHM_ASTAR}};
+    preview.pending.clear();
+    for (int i = 5; i >= 0; --i)
+    {
+        const SolveKey &n = neighbors[i];
+        if (n.missionaries >= 0 && n.cannibals >= 0 && n.boat_capacity >= 1 && n.boat_capacity <= MAX_BOAT_CAPACITY && !preview.known_moves.count(n))
+            preview.pending.push_back(n);
+    }
+    if (!known && preview.solvable)
+        preview.pending.push_back(key);
+
+    // La búsqueda en curso no se pierde si es del problema mostrado, o si es de un vecino y el problema mostrado ya se conoce
+    if (preview.searching)
+    {
+        auto current = find(preview.pending.begin(), preview.pending.end(), preview.search_key);
+        if (current != preview.pending.end() && (current + 1 == preview.pending.end() || known || !preview.solvable))
+        {
+            preview.pending.erase(current);
+            return;
+        }
+    }
+    start_next_preview_search(preview);
+    if (preview.searching)
+        step_menu_preview(preview);
+}
+
+// Limite de estados posibles del problema para construir el grafo de soluciones mas cortas desde la simulación (32 MB de tablas),
+// se construye en el hilo principal, con este limite tarda menos de un segundo
+const size_t max_browse_states = size_t(1) << 22;
+// Bloques de 9 dígitos hasta los que se cuentan las soluciones mas cortas en pantalla, con mas solo se muestra la cota
+const size_t max_browse_count_limbs = 4;
+
+// Recorrido de las soluciones mas cortas con N (siguiente) y P (anterior) en la pantalla de la solución
+struct ShortestBrowser
+{
+    ShortestPathDag dag;
+    ShortestPathEnumerator enumerator;
+    // Problema para el que se construyo el grafo (-1 si aun no se construye) y si no se pudo construir por ser muy grande
+    int built_m, built_c, built_k;
+    bool too_large;
+    // Numero de soluciones mas cortas ya como texto, y cual se esta mostrando (0 si se muestra la que encontró el algoritmo)
+    string count_text;
+    long long index;
+    // Numero de soluciones mas cortas, o -1 si no cabe en un long long (en ese caso no se puede saltar a la ultima)
+    long long total;
+};
+
+// Cambia path por la solución mas corta que sigue (direction 1) o la anterior (direction -1), al pasar de la ultima se
+// regresa a la primera y antes de la primera sigue la ultima, devuelve false si no se pudo construir el grafo
+bool browse_shortest(ShortestBrowser &browser, int total_m, int total_c, int boat_capacity, int direction, vector<State> &path)
+{
+    if (browser.built_m != total_m || browser.built_c != total_c || browser.built_k != boat_capacity)
+    {
+        browser.built_m = total_m;
+        browser.built_c = total_c;
+        browser.built_k = boat_capacity;
+        browser.index = 0;
+        browser.too_large = !browser.dag.build(total_m, total_c, boat_capacity, max_browse_states);
+        if (!browser.too_large)
+        {
+            bool truncated;
+            BigCount count = browser.dag.count_paths(max_browse_count_limbs, &truncated);
+            browser.count_text = truncated ? "more than 10^" + to_string(9 * max_browse_count_limbs) : count.to_string();
+            // Con 2 bloques de 9 dígitos el numero es menor a 10^18 y cabe en un long long
+            browser.total = -1;
+            if (!truncated && count.limbs.size() <= 2)
+                browser.total = (long long)count.limbs[0] + (count.limbs.size() > 1 ? (long long)count.limbs[1] * BigCount::BASE : 0);
+        }
+    }
+    if (browser.too_large)
+        return false;
+
+    // Si se esta mostrando la solución del algoritmo (por ejemplo después de reiniciar), el recorrido empieza de nuevo
+    if (browser.index == 0)
+        browser.enumerator.start(browser.dag);
+
+    if (direction > 0)
+    {
+        if (!browser.enumerator.next(path))
+        {
+            // Ya no hay mas, regresamos a la primera
+            browser.enumerator.start(browser.dag);
+            browser.enumerator.next(path);
+        }
+    }
+    else if (browser.index > 1)
+        browser.enumerator.previous(path);
+    // Antes de la primera (o de la solución del algoritmo) sigue la ultima, si no se sabe su numero se muestra la primera
+    else if (browser.total > 0)
+        browser.enumerator.last(path, browser.total);
+    else
+    {
+        browser.enumerator.start(browser.dag);
+        browser.enumerator.next(path);
+    }
+    browser.index = browser.enumerator.produced;
+    return true;
+}
+
+// Velocidades de la animación (pasos por segundo) que se recorren con UP/DOWN, las mayores a 60 avanzan varios pasos en cada
+// frame y los pasos intermedios simplemente no se dibujan
+const float playback_speeds[] = {0.5f, 1.0f, 2.0f, 3.0f, 5.0f, 10.0f, 20.0f, 50.0f, 100.0f, 200.0f, 500.0f, 1000.0f};
+const int playback_speed_count = sizeof(playback_speeds) / sizeof(playback_speeds[0]);
+// Velocidad con la que empieza cada animación (1x)
+const int default_playback_speed = 1;
+
+// Reproducción de la solución: la posición es un numero de pasos con fracción, la parte entera es el estado que se muestra y
+// la fracción lo que ha avanzado el bote desde el estado anterior. Como el camino ya esta completo en un vector, avanzar o
+// saltar a cualquier paso solo cambia este numero, el costo de cada frame es el mismo sin importar la velocidad ni la longitud
+struct Playback
+{
+    double position;
+    // Numero de estados del camino, la animación termina cuando la posición llega a este valor
+    size_t steps;
+    int speed_index;
+    // Si ya se llego al final alguna vez con este camino (para guardar los resultados solo una vez)
+    bool reached_end;
+};
+
+// Empieza la reproducción de un camino nuevo desde el inicio a la velocidad normal
+void reset_playback(Playback &playback, size_t steps)
+{
+    playback.position = 0;
+    playback.steps = steps;
+    playback.speed_index = default_playback_speed;
+    playback.reached_end = false;
+}
+
+float playback_speed(const Playback &playback)
+{
+    return playback_speeds[playback.speed_index];
+}
+
+// Paso del camino que se muestra
+size_t playback_step(const Playback &playback)
+{
+    return min((size_t)playback.position, playback.steps == 0 ? 0 : playback.steps - 1);
+}
+
+// Avance del bote desde el estado anterior (entre 0 y 1), a mas de un paso por frame el bote se dibuja quieto en cada paso
+float playback_progress(const Playback &playback, double frame_seconds)
+{
+    if (playback.position >= playback.steps || playback_speed(playback) * frame_seconds > 1.0)
+        return 0.0f;
+    return (float)(playback.position - (size_t)playback.position);
+}
+
+// Salta al paso dado (con el bote ya en la orilla), sin salirse del camino
+void seek_playback(Playback &playback, double step)
+{
+    double last = playback.steps == 0 ? 0 : playback.steps - 1;
+    playback.position = max(0.0, min(last, floor(step)));
+}
+
+// Avanza la animación seconds segundos, devuelve true si con esto llego al final del camino
+bool advance_playback(Playback &playback, double seconds)
+{
+    playback.position = min((double)playback.steps, playback.position + seconds * playback_speed(playback));
+    return playback.position >= playback.steps;
+}
+
+// Barra de la reproducción, debajo de los textos de la esquina superior izquierda, se puede hacer clic o arrastrar sobre ella
+const float scrub_bar_x = 10, scrub_bar_y = 92, scrub_bar_height = 8;
+const float scrub_bar_width = screen_width - 2 * scrub_bar_x;
+
+// Si el punto (x, y) esta sobre la barra (con un margen para que sea fácil atinarle)
+bool on_scrub_bar(int x, int y)
+{
+    return x >= scrub_bar_x - 4 && x <= scrub_bar_x + scrub_bar_width + 4 && y >= scrub_bar_y - 6 && y <= scrub_bar_y + scrub_bar_height + 6;
+}
+
+// Paso del camino que corresponde a la posición x sobre la barra
+double scrub_bar_step(const Playback &playback, int x)
+{
+    double fraction = max(0.0, min(1.0, (x - scrub_bar_x) / (double)scrub_bar_width));
+    return fraction * (playback.steps == 0 ? 0 : playback.steps - 1);
+}
+
+// Dibuja la barra con la parte ya recorrida y el paso actual, siempre son las mismas 3 figuras y un texto
+void draw_scrub_bar(const Playback &playback, ALLEGRO_FONT *font)
+{
+    size_t last = playback.steps == 0 ? 0 : playback.steps - 1;
+    float fraction = last == 0 ? 1.0f : (float)(min(playback.position, (double)last) / last);
+    float filled_x = scrub_bar_x + fraction * scrub_bar_width;
+
+    al_draw_filled_rectangle(scrub_bar_x, scrub_bar_y, scrub_bar_x + scrub_bar_width, scrub_bar_y + scrub_bar_height, palette.bar_background);
+    al_draw_filled_rectangle(scrub_bar_x, scrub_bar_y, filled_x, scrub_bar_y + scrub_bar_height, palette.bar_fill);
+    al_draw_filled_rectangle(filled_x - 2, scrub_bar_y - 3, filled_x + 2, scrub_bar_y + scrub_bar_height + 3, palette.white);
+    frame_draw_calls += 3;
+
+    char step_text[64];
+    snprintf(step_text, sizeof(step_text), "Step %llu / %llu", (unsigned long long)playback_step(playback), (unsigned long long)last);
+    draw_text(font, palette.hint_text, scrub_bar_x, scrub_bar_y + scrub_bar_height + 6, ALLEGRO_ALIGN_LEFT, step_text);
+}
+
+// Panel de instrumentación (se muestra con F3), con los percentiles del tiempo entre frames y del tiempo de dibujo, las
+// llamadas de dibujo y eventos del ultimo frame, y el tiempo y estados de la ultima resolución
+void draw_profiler_overlay(FrameProfiler &profiler, ALLEGRO_FONT *font, double last_solve_seconds, long long last_solve_states,
+                           SolverAlgorithm algorithm)
+{
+    float x = 10, y = 70;
+    ALLEGRO_COLOR color = palette.profiler_text;
+    al_draw_filled_rectangle(x - 5, y - 5, x + 430, y + 75, palette.overlay_background);
+    frame_draw_calls++;
+
+    // Los valores cambian en cada frame, se formatean en un arreglo en la pila en lugar de usar al_draw_textf, que reserva
+    // memoria en cada llamada
+    char line[128];
+    snprintf(line, sizeof(line), "frame interval p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms",
+             profiler.percentile(&FrameSample::interval_ms, 0.50), profiler.percentile(&FrameSample::interval_ms, 0.95),
+             profiler.percentile(&FrameSample::interval_ms, 0.99), profiler.percentile(&FrameSample::interval_ms, 1.0));
+    draw_text(font, color, x, y, ALLEGRO_ALIGN_LEFT, line);
+    snprintf(line, sizeof(line), "render time    p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms",
+             profiler.percentile(&FrameSample::render_ms, 0.50), profiler.percentile(&FrameSample::render_ms, 0.95),
+             profiler.percentile(&FrameSample::render_ms, 0.99), profiler.percentile(&FrameSample::render_ms, 1.0));
+    draw_text(font, color, x, y + 12, ALLEGRO_ALIGN_LEFT, line);
+
+    // Datos del frame anterior (el actual aun no termina de dibujarse)
+    const FrameSample &last = profiler.last_frame();
+    snprintf(line, sizeof(line), "draw calls %d  events/frame %d  dropped ticks %d", profiler.frame_count ? last.draw_calls : 0,
+             profiler.frame_count ? last.events : 0, profiler.frame_count ? last.timer_lag : 0);
+    draw_text(font, color, x, y + 24, ALLEGRO_ALIGN_LEFT, line);
+    snprintf(line, sizeof(line), "last solve (%s): %.3f s, %lld states", algorithm_name(algorithm), last_solve_seconds, last_solve_states);
+    draw_text(font, color, x, y + 36, ALLEGRO_ALIGN_LEFT, line);
+    draw_text(font, palette.hint_text, x, y + 56, ALLEGRO_ALIGN_LEFT, "F3 - Hide | F5 - Save trace.json");
+}
+
+// Exportación de la animación como una secuencia de imágenes PNG numeradas (frame_000000.png, frame_000001.png, ...) que ffmpeg
+// puede juntar en un video. No se crea ninguna ventana: cada frame se dibuja con draw_state en un bitmap de memoria tan rápido
+// como se pueda, sin esperar al temporizador, y un grupo de hilos codifica y guarda los PNG al mismo tiempo que el hilo
+// principal dibuja los siguientes. Hay un numero fijo de bitmaps que van y vienen entre el que dibuja y los que guardan, si
+// guardar es mas lento que dibujar el hilo principal espera a que se libere alguno, asi la memoria no crece con el camino
+struct FrameExportPipeline
+{
+    mutex lock;
+    condition_variable changed;
+    // Bitmaps libres para dibujar el siguiente frame
+    vector<ALLEGRO_BITMAP *> free_bitmaps;
+    // Frames ya dibujados (numero y bitmap) esperando a que un hilo los guarde
+    deque<pair<long long, ALLEGRO_BITMAP *> > pending;
+    // Se pone en true cuando ya no se van a dibujar mas frames
+    bool finished;
+    string directory;
+    // Frames que no se pudieron guardar
+    long long failed;
+};
+
+// Ciclo de cada hilo que guarda frames, toma el siguiente frame pendiente, lo guarda y regresa su bitmap a los libres
+void frame_export_worker(FrameExportPipeline &pipeline)
+{
+    char file_name[512];
+    unique_lock<mutex> guard(pipeline.lock);
+    while (true)
+    {
+        pipeline.changed.wait(guard, [&pipeline]() { return !pipeline.pending.empty() || pipeline.finished; });
+        if (pipeline.pending.empty())
+            return;
+        pair<long long, ALLEGRO_BITMAP *> frame = pipeline.pending.front();
+        pipeline.pending.pop_front();
+
+        // El PNG se codifica sin tener el mutex, es la parte lenta
+        guard.unlock();
+        snprintf(file_name, sizeof(file_name), "%s/frame_%06lld.png", pipeline.directory.c_str(), frame.first);
+        bool saved = al_save_bitmap(file_name, frame.second);
+        guard.lock();
+
+        if (!saved)
+            pipeline.failed++;
+        pipeline.free_bitmaps.push_back(frame.second);
+        pipeline.changed.notify_all();
+    }
+}
+
+// Dibuja la animación de path con frames_per_step frames por paso y la guarda en directory usando num_threads hilos, devuelve
+// el numero de frames, -1 si no se pudo guardar alguno o -2 si no se pudieron crear los bitmaps de los frames
+long long export_solution_frames(const vector<State> &path, int total_m, int total_c, const string &directory, int frames_per_step,
+                                 int num_threads, ALLEGRO_FONT *font, SceneCache &scene, const SpriteAtlas &atlas)
+{
+    FrameExportPipeline pipeline;
+    pipeline.finished = false;
+    pipeline.directory = directory;
+    pipeline.failed = 0;
+    // 2 bitmaps por hilo, uno que se guarda mientras el otro espera, mas el que se esta dibujando
+    for (int i = 0; i < 2 * num_threads + 1; ++i)
+    {
+        ALLEGRO_BITMAP *bitmap = al_create_bitmap(screen_width, screen_height);
+        if (!bitmap)
+        {
+            // Sin memoria para los frames no se dibuja nada, se liberan los que si se crearon
+            for (size_t j = 0; j < pipeline.free_bitmaps.size(); ++j)
+                al_destroy_bitmap(pipeline.free_bitmaps[j]);
+            return -2;
+        }
+        pipeline.free_bitmaps.push_back(bitmap);
+    }
+
+    vector<thread> workers;
+    for (int i = 0; i < num_threads; ++i)
+        workers.push_back(thread(frame_export_worker, ref(pipeline)));
+
+    // Se recorre la posición igual que en la animación, de 0 hasta el numero de estados, mas un frame final con el bote quieto
+    Playback playback;
+    reset_playback(playback, path.size());
+    long long total_frames = (long long)path.size() * frames_per_step + 1;
+    for (long long frame = 0; frame < total_frames; ++frame)
+    {
+        ALLEGRO_BITMAP *bitmap;
+        {
+            unique_lock<mutex> guard(pipeline.lock);
+            pipeline.changed.wait(guard, [&pipeline]() { return !pipeline.free_bitmaps.empty(); });
+            bitmap = pipeline.free_bitmaps.back();
+            pipeline.free_bitmaps.pop_back();
+        }
+
+        playback.position = min((double)path.size(), (double)frame / frames_per_step);
+        size_t step = playback_step(playback);
+        float progress = playback_progress(playback, 1.0 / frames_per_step);
+        al_set_target_bitmap(bitmap);
+        al_clear_to_color(palette.black);
+        draw_state(path[step], step > 0 && progress > 0.0f ? &path[step - 1] : nullptr, total_m, total_c, font, progress, scene, atlas);
+        draw_scrub_bar(playback, font);
+
+        {
+            lock_guard<mutex> guard(pipeline.lock);
+            pipeline.pending.push_back(make_pair(frame, bitmap));
+        }
+        pipeline.changed.notify_all();
+    }
+
+    {
+        lock_guard<mutex> guard(pipeline.lock);
+        pipeline.finished = true;
+    }
+    pipeline.changed.notify_all();
+    for (size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+
+    al_set_target_bitmap(nullptr);
+    for (size_t i = 0; i < pipeline.free_bitmaps.size(); ++i)
+        al_destroy_bitmap(pipeline.free_bitmaps[i]);
+    return pipeline.failed > 0 ? -1 : total_frames;
+}
+
+// Modo de exportación (--export): resuelve el problema y guarda su animación en directory sin abrir la ventana, los addons ya
+// deben de estar iniciados. Devuelve el código de salida del programa
+int run_frame_export(int total_m, int total_c, int boat_capacity, SolverAlgorithm algorithm, const string &directory, int frames_per_step,
+                     int num_threads)
+{
+    vector<State> path;
+    if (!solve_mc(total_m, total_c, boat_capacity, path, algorithm))
+    {
+        cerr << "No solution found for these values." << endl;
+        return 2;
+    }
+    if (!al_make_directory(directory.c_str()))
+    {
+        cerr << "Error: Could not create the directory " << directory << "." << endl;
+        return 1;
+    }
+
+    // Sin pantalla todos los bitmaps (los frames, el fondo, el atlas y la fuente) son de memoria, y allegro los dibuja con el
+    // procesador
+    al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP);
+    ALLEGRO_FONT *font = al_create_builtin_font();
+    SpriteAtlas atlas = {nullptr};
+    if (!font || !create_sprite_atlas(atlas))
+    {
+        cerr << "Error: Could not create the font or the sprite atlas." << endl;
+        if (font)
+            al_destroy_font(font);
+        return 1;
+    }
+    SceneCache scene = {nullptr, 0, 0, 0, 0, {}, {}};
+    // El fondo se crea antes de empezar para no dibujar sobre un bitmap que no existe
+    if (!get_static_scene(scene, screen_width, screen_height, total_m, total_c, font))
+    {
+        cerr << "Error: Could not create the " << screen_width << "x" << screen_height << " background bitmap." << endl;
+        destroy_sprite_atlas(atlas);
+        al_destroy_font(font);
+        return 1;
+    }
+
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+    long long frames = export_solution_frames(path, total_m, total_c, directory, frames_per_step, num_threads, font, scene, atlas);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+    destroy_scene_cache(scene);
+    destroy_sprite_atlas(atlas);
+    al_destroy_font(font);
+
+    if (frames == -2)
+    {
+        cerr << "Error: Could not create the " << screen_width << "x" << screen_height << " frame bitmaps (out of memory)." << endl;
+        return 1;
+    }
+    if (frames < 0)
+    {
+        cerr << "Error: Could not save some frames in " << directory << "." << endl;
+        return 1;
+    }
+    cerr << path.size() - 1 << " moves, " << frames << " frames saved in " << directory << " in " << seconds << " s ("
+         << (seconds > 0 ? frames / seconds : 0) << " frames/s)" << endl;
+    cerr << "To join them into a video: ffmpeg -framerate 30 -i " << directory << "/frame_%06d.png -pix_fmt yuv420p solution.mp4" << endl;
+    return 0;
 }
 
-int main()
+// Textos de la interfaz de cada pantalla, cada uno se vuelve a formatear solo cuando cambia lo que muestra (ver HudText)
+struct HudCache
 {
+    // Menu
+    HudText missionaries, cannibals, capacity, algorithm, preview;
+    // Animación, búsqueda y resultados
+    HudText speed, stats, shortest, saved, progress;
+};
+
+int main(int argc, char *argv[])
+{
+    // Capacidad del bote con la que se va a resolver el problema, se puede dar desde la linea de comandos con
+    // --capacity N y después cambiar en el menu
+    int boat_capacity_input = DEFAULT_BOAT_CAPACITY;
+    // Formato del archivo de resultados, texto (results.txt) o binario (results.bin)
+    ResultsFormat results_format = RESULTS_TEXT;
+    // Exportación de la animación a imágenes (--export M C DIR), si export_directory esta vacío se abre la simulación normal
+    string export_directory;
+    int export_m = 0, export_c = 0;
+    SolverAlgorithm export_algorithm = ALGORITHM_BFS;
+    int frames_per_step = 10;
+    int export_threads = max(1, (int)thread::hardware_concurrency());
+
+    /* ------ Leer argumentos de la linea de comandos ------ */
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if ((arg == "--capacity" || arg == "-k") && i + 1 < argc)
+        {
+            boat_capacity_input = atoi(argv[++i]);
+        }
+        else if (arg == "--results-format" && i + 1 < argc && parse_results_format(argv[i + 1], results_format))
+        {
+            ++i;
+        }
+        // Los misioneros y caníbales se revisan igual que en mc_cli, si no son números validos se muestra como se usa
+        else if (arg == "--export" && i + 3 < argc && parse_count(argv[i + 1], export_m) && parse_count(argv[i + 2], export_c))
+        {
+            i += 2;
+            export_directory = argv[++i];
+        }
+        else if (arg == "--algorithm" && i + 1 < argc && parse_algorithm(argv[i + 1], export_algorithm))
+        {
+            ++i;
+        }
+        else if (arg == "--frames-per-step" && i + 1 < argc)
+        {
+            frames_per_step = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--jobs" && i + 1 < argc)
+        {
+            export_threads = max(1, atoi(argv[++i]));
+        }
+        else
+        {
+            cerr << "Usage: " << argv[0] << " [--capacity N] [--results-format text|binary]" << endl;
+            cerr << "       " << argv[0] << " --export <missionaries> <cannibals> <directory> [--capacity N] [--algorithm dfs|bfs|bidi|astar]"
+                 << " [--frames-per-step N] [--jobs N]" << endl;
+            return 1;
+        }
+    }
+    // Mantenemos la capacidad dentro de los limites que acepta el solucionador
+    if (boat_capacity_input < 1 || boat_capacity_input > MAX_BOAT_CAPACITY)
+    {
+        cerr << "Error: boat capacity must be between 1 and " << MAX_BOAT_CAPACITY << "." << endl;
+        return 1;
+    }
 
     /* ------ Iniciar addons ------ */
 
@@ -451,8 +1229,27 @@ int main()
 
     // Iniciamos allegro
     al_init();
+    // Convertimos los colores de la paleta una sola vez
+    init_palette();
+
+    // En el modo de exportación no se abre la ventana ni se usan el teclado o el mouse, solo los addons de dibujo y el de imágenes
+    // para guardar los PNG
+    if (!export_directory.empty())
+    {
+        al_init_primitives_addon();
+        al_init_font_addon();
+        al_init_image_addon();
+        int status = run_frame_export(export_m, export_c, boat_capacity_input, export_algorithm, export_directory, frames_per_step, export_threads);
+        al_shutdown_image_addon();
+        al_shutdown_primitives_addon();
+        al_shutdown_font_addon();
+        return status;
+    }
+
     // Iniciamos el teclado
     al_install_keyboard();
+    // Y el mouse, para la barra de la reproducción
+    al_install_mouse();
     // Iniciamos el addon para poder dibujar figuras
     al_init_primitives_addon();
     // Inicializar addon de fuente
@@ -462,7 +1259,9 @@ int main()
     ALLEGRO_TIMER *timer = al_create_timer(1.0 / 60.0);
     // Creamos una cola de eventos, esto se hace para manejar input dado por el usuario, ver https://shorturl.at/1pUjt
     ALLEGRO_EVENT_QUEUE *event_queue = al_create_event_queue();
-    // Creamos nuestra pantalla pasándole el alto y ancho definido en las constantes
+    // Creamos nuestra pantalla pasándole el alto y ancho definido en las constantes, pidiendo que avise cuando se tenga que volver a
+    // dibujar (por ejemplo al dejar de estar tapada por otra ventana), ya que en las pantallas sin cambios no se dibuja cada frame
+    al_set_new_display_flags(ALLEGRO_GENERATE_EXPOSE_EVENTS);
     ALLEGRO_DISPLAY *display = al_create_display(screen_width, screen_height);
     // Para simplicidad del proyecto, trabajamos con la fuente base de allegro: "Creates a monochrome bitmap font (8x8 pixels per character)." según
     // la documentación oficial
@@ -470,9 +1269,11 @@ int main()
 
     // Registramos el "event source" en nuestra cola de eventos para los siguientes eventos:
     // - El teclado
+    // - El mouse
     // - La pantalla
     // - El temporizador
     al_register_event_source(event_queue, al_get_keyboard_event_source());
+    al_register_event_source(event_queue, al_get_mouse_event_source());
     al_register_event_source(event_queue, al_get_display_event_source(display));
     al_register_event_source(event_queue, al_get_timer_event_source(timer));
 
@@ -487,30 +1288,78 @@ int main()
     // Creamos nuestras variables para guardar el input ingresado por el usuario (iniciamos con 3 misioneros y 3 caníbales)
     int num_missionaries_input = 3;
     int num_cannibals_input = 3;
-    // Para saber en que campo estamos durante el menu de selección, marcamos 2 estados:
+    // Para saber en que campo estamos durante el menu de selección, marcamos 3 estados:
     // - 0 seleccionando el campo misioneros
     // - 1 seleccionando el campo caníbales
+    // - 2 seleccionando el campo capacidad del bote
     int selected_input_field = 0;
 
-    // Marcamos la velocidad inicial en 1
-    float simulation_speed = 1.0f;
+    // Algoritmo con el que se va a resolver el problema, se cambia con TAB en el menu
+    SolverAlgorithm selected_algorithm = ALGORITHM_DFS;
+    // Estadísticas de la ultima resolución (estados expandidos) para mostrarlas en pantalla
+    SolveStats last_solve_stats = {};
+    // Tiempo en segundos que tardo la ultima resolución
+    double last_solve_seconds = 0;
+    // Si el resultado que se muestra salió del cache en lugar de una búsqueda
+    bool last_solve_cached = false;
+    // Cache de soluciones, se carga del archivo de la ejecución anterior (si existe) y se guarda al salir
+    SolutionCache solution_cache;
+    {
+        ifstream cache_file(DEFAULT_CACHE_FILE, ios::binary);
+        if (cache_file.is_open() && !solution_cache.load(cache_file))
+            cerr << "Warning: " << DEFAULT_CACHE_FILE << " is not a valid cache file, only the entries read so far are used." << endl;
+    }
+    // Resolución en segundo plano, se usa durante la fase SEARCHING
+    BackgroundSolve background_solve;
+    // Escritura del archivo de resultados en segundo plano, empieza al llegar a SOLVED
+    ResultsWriter results_writer;
+    // Vista previa del problema elegido en el menu, con -1 en los totales para que se calcule en el primer frame
+    MenuPreview menu_preview;
+    menu_preview.total_m = menu_preview.total_c = menu_preview.boat_capacity = -1;
+    menu_preview.searching = false;
+    // Soluciones mas cortas alternativas, el grafo se construye la primera vez que se presiona N o P
+    ShortestBrowser shortest_browser;
+    shortest_browser.built_m = shortest_browser.built_c = shortest_browser.built_k = -1;
+    shortest_browser.too_large = false;
+    shortest_browser.index = 0;
+    shortest_browser.total = -1;
+    // Fondo estático de la simulación, se dibuja la primera vez que se necesita
+    SceneCache scene_cache = {nullptr, 0, 0, 0, 0, {}, {}};
+    // Textos de la interfaz ya formateados
+    HudCache hud = {};
+    // Figuras de los misioneros y caníbales, se dibujan una sola vez al iniciar
+    SpriteAtlas sprite_atlas = {nullptr};
+    if (!create_sprite_atlas(sprite_atlas))
+    {
+        cerr << "Error: Could not create the sprite atlas." << endl;
+        return 1;
+    }
+
+    // Instrumentación: los últimos 10 segundos de frames para los percentiles y hasta 16384 eventos para la traza
+    FrameProfiler profiler(600, 16384);
+    bool show_profiler = false;
+    // Eventos y ticks del temporizador que llegaron desde el ultimo frame dibujado
+    int events_since_frame = 0;
+    int timer_ticks_since_frame = 0;
 
     // Declaramos un vector que va a guardar estructuras de tipo State
     vector<State> solution_path;
-    // Este va a ser nuestro indice para el vector
-    int current_solution_step = 0;
-    // Simple variable para almacenar la duración del frame
-    float time_since_last_step = 0.0f;
-
-    // Esta variable nos ayuda a "animar" el bote durante la resolución, donde es 0.0 al inicio del movimiento
-    // y 1.0 al finalizarlo
-    float boat_animation_progress = 0.0f;
+    // Reproducción del camino: en que paso vamos, cuanto ha avanzado el bote y a que velocidad
+    Playback playback;
+    reset_playback(playback, 0);
+    // Si se esta arrastrando la barra de la reproducción con el mouse
+    bool scrubbing = false;
 
-    // Antes de iniciar todo el ciclo de la simulación, iniciamos nuestro timer
+    // Antes de iniciar todo el ciclo de la simulación, iniciamos nuestro timer (el ciclo lo detiene en cuanto no hace falta)
     al_start_timer(timer);
 
-    // Esta variable nos indica si debemos de hacer una "actualización" (un fotograma) de nuestra pantalla
-    bool redraw;
+    // Esta variable nos indica si debemos de hacer una "actualización" (un fotograma) de nuestra pantalla, el primer frame
+    // siempre se dibuja
+    bool redraw = true;
+#ifdef MC_DEBUG_ALLOCS
+    // Fase del ultimo frame dibujado, para revisar las reservas de memoria solo en los frames estables
+    CurrentPhase last_drawn_phase = current_phase;
+#endif
 
     // Ciclo infinito para nuestra simulación
     while (1)
@@ -518,6 +1367,7 @@ int main()
         // Aquí estaremos esperando unicamente por los event sources especificados anteriormente en la función
         // al_register_event_source(), ver https://shorturl.at/KBKRk entender como funciona esta función tan importante
         al_wait_for_event(event_queue, &event);
+        events_since_frame++;
 
         // Si el evento a procesar el el timer, el cual sera cierto si es que no hay ningún input por parte del usuario, (hay que recordar que el
         // timer da una señal cada 1.0 / 60.0s) entonces ingresamos a este if
@@ -525,88 +1375,103 @@ int main()
         {
             // Tras cada frame, se dibujara nuevamente
             redraw = true;
+            timer_ticks_since_frame++;
+
+            // En el menu actualizamos la vista previa con los valores elegidos
+            if (current_phase == KEYBOARD_INPUT)
+                update_menu_preview(menu_preview, num_missionaries_input, num_cannibals_input, boat_capacity_input);
+
+            // Si estamos buscando la solución en otro hilo, revisamos (sin esperar) si ya termino
+            if (current_phase == SEARCHING && background_solve.done.load())
+            {
+                // El hilo ya termino, por lo que join regresa de inmediato
+                background_solve.worker.join();
+                // Tomamos el camino encontrado sin copiarlo
+                solution_path.swap(background_solve.path);
+                last_solve_stats = background_solve.stats;
+                last_solve_seconds = chrono::duration<double>(background_solve.finished - background_solve.started).count();
+                // Guardamos el resultado (con o sin solución) para no tener que volver a buscarlo
+                SolveKey key = {num_missionaries_input, num_cannibals_input, boat_capacity_input, selected_algorithm};
+                solution_cache.store(key, background_solve.solved, last_solve_stats.states_expanded, solution_path);
+                // La resolución se agrega a la traza en la fila del hilo que resuelve
+                TraceEvent solve_event = {"solve", 'X', TRACE_SOLVER_THREAD, profiler.to_us(background_solve.started),
+                                          last_solve_seconds * 1e6, last_solve_stats.states_expanded};
+                profiler.add_trace(solve_event);
+                // Si se encontró una solución empezamos la animación, si no, mostramos que no hay solución
+                current_phase = background_solve.solved ? SOLVING : NO_SOLUTION;
+                reset_playback(playback, solution_path.size());
+            }
 
             // Si ya estamos mostrando la solución, significa que el vector no esta vacio, ya que la función solve_mc lo lleno
             // con toda la secuencia de estados para llegar a la solución
             if (current_phase == SOLVING && !solution_path.empty())
             {
-                // Guardamos el tiempo pasado en un frame, acumulándolo para controlar la duración del paso actual de la animación
-                time_since_last_step += (1.0 / 60.0);
-                // Calculamos el progreso de la animación del bote como una fracción de la duración total del paso,
-                // esto depende del tiempo acumulado y la velocidad de simulación elegida por el usuario
-                boat_animation_progress = time_since_last_step * simulation_speed;
-                // Aseguramos que el progreso no exceda 1, significando movimiento finalizado
-                boat_animation_progress = min(1.0f, boat_animation_progress);
-
-                // Si el tiempo acumulado es mayor o igual a la duración esperada para un paso de la animación,
-                // significa que la animación de este paso ha concluido
-                if (time_since_last_step >= (1.0 / simulation_speed))
+                // Avanzamos la animación lo que dura un frame a la velocidad elegida, a velocidades altas esto salta varios pasos
+                // de una vez sin dibujar los de en medio. Mientras se arrastra la barra la animación se queda donde esta el mouse
+                if (!scrubbing && advance_playback(playback, 1.0 / 60.0))
                 {
-                    // Avanzamos al siguiente paso de la solución, nuestro indice en el vector
-                    current_solution_step++;
-
-                    // Si hemos superado el último paso de la solución
-                    if (current_solution_step >= solution_path.size())
-                    {
-                        // Cambiamos la fase a SOLVED, indicando que la simulación ha terminado
-                        current_phase = SOLVED;
-                        // Mantenemos el índice en el último paso para mostrar el estado final
-                        current_solution_step = solution_path.size() - 1;
-                        // Reiniciamos el progreso del bote para que se muestre estático en la orilla final
-                        boat_animation_progress = 0.0f;
-
-                        // Abrimos el archivo resultados, y si este no existe, entonces lo creamos
-                        ofstream results_file("results.txt");
-
-                        // Verificamos si este se abrio correctamente
-                        if (results_file.is_open())
-                        {
-                            // Imprimimos arriba de este archivo la información sobre el problema que se resolvió
-                            results_file << "Solution for Missionaries: " << num_missionaries_input << ", Cannibals: " << num_cannibals_input << endl;
-                            results_file << "Boat capacity: " << BOAT_CAPACITY << endl;
-                            results_file << "------------------------------------------" << endl;
-                            // Recorremos nuestro vector
-                            for (size_t i = 0; i < solution_path.size(); ++i)
-                            {
-                                // Guardamos una instancia temporal para el estado del vector
-                                State &s = solution_path[i];
-                                // Imprimimos la información de este estado en el archivo
-                                results_file << "Step " << i << ": "
-                                                   << "Left(M:" << s.m_left << ", C:" << s.c_left << ") "
-                                                   << "Right(M:" << s.m_right << ", C:" << s.c_right << ") "
-                                                   << "Boat:" << (s.boat_pos == 0 ? "Left" : "Right") << endl;
-                            }
-                            // Tras finalizar cerramos el archivo
-                            results_file.close();
-                        }
-                        else
-                        // Si no se pudo abrir o crear
-                        {
-                            // cerr se utiliza como un cout pero este esta especializado para mandar mensajes de errores en stderr, ademas
-                            // de que este no se guarda en buffer y se muestra inmediatamente
-                            cerr << "Error: Could not open results.txt to save the results." << endl;
-                        }
-                    }
-                    else
-                    {
-                        // Si aún hay pasos, reiniciamos el progreso del bote para la animación del nuevo paso
-                        boat_animation_progress = 0.0f;
-                    }
-                    // Reseteamos el contador de tiempo para el nuevo paso de la animación
-                    time_since_last_step = 0;
+                    // Cambiamos la fase a SOLVED, indicando que la simulación ha terminado
+                    current_phase = SOLVED;
+
+                    // La primera vez que se llega al final guardamos la solución en el archivo de resultados desde otro hilo, asi el
+                    // ciclo de eventos sigue dibujando aunque el camino tenga cientos de miles de pasos
+                    if (!playback.reached_end)
+                        start_results_write(results_writer, results_format, solution_path, num_missionaries_input, num_cannibals_input,
+                                            boat_capacity_input);
+                    playback.reached_end = true;
                 }
             }
         }
+        // Al hacer clic sobre la barra de la reproducción saltamos a ese paso, y si se mantiene el botón la seguimos mientras se
+        // arrastra
+        else if (event.type == ALLEGRO_EVENT_MOUSE_BUTTON_DOWN || event.type == ALLEGRO_EVENT_MOUSE_AXES ||
+                 event.type == ALLEGRO_EVENT_MOUSE_BUTTON_UP)
+        {
+            if (event.type == ALLEGRO_EVENT_MOUSE_BUTTON_UP)
+                scrubbing = false;
+            else if ((current_phase == SOLVING || current_phase == SOLVED) && !solution_path.empty() &&
+                     (scrubbing || (event.type == ALLEGRO_EVENT_MOUSE_BUTTON_DOWN && on_scrub_bar(event.mouse.x, event.mouse.y))))
+            {
+                scrubbing = true;
+                seek_playback(playback, scrub_bar_step(playback, event.mouse.x));
+                current_phase = SOLVING;
+                redraw = true;
+            }
+        }
         // Si el evento procesado es la "X" en nuestra ventana, entonces rompemos el ciclo y terminara el programa
         else if (event.type == ALLEGRO_EVENT_DISPLAY_CLOSE)
         {
             break;
         }
+        // Si la ventana se destapa o vuelve a estar al frente su contenido se pudo perder, por lo que la volvemos a dibujar
+        else if (event.type == ALLEGRO_EVENT_DISPLAY_EXPOSE || event.type == ALLEGRO_EVENT_DISPLAY_SWITCH_IN)
+        {
+            redraw = true;
+        }
         // Si se pulsa un tecla (KEY_DOWN)
         else if (event.type == ALLEGRO_EVENT_KEY_DOWN)
         {
-            // Si la tecla presionada es el ESC, entonces rompemos el ciclo y terminara el programa
-            if (event.keyboard.keycode == ALLEGRO_KEY_ESCAPE)
+            // Cualquier tecla puede cambiar lo que se muestra
+            redraw = true;
+
+            // F3 muestra u oculta el panel de instrumentación y F5 guarda la traza, en cualquier fase
+            if (event.keyboard.keycode == ALLEGRO_KEY_F3)
+                show_profiler = !show_profiler;
+            else if (event.keyboard.keycode == ALLEGRO_KEY_F5)
+            {
+                ofstream trace_file("trace.json");
+                if (trace_file.is_open())
+                {
+                    profiler.write_chrome_trace(trace_file);
+                    cerr << "Trace saved in trace.json (open it in chrome://tracing or ui.perfetto.dev)" << endl;
+                }
+                else
+                    cerr << "Error: Could not open trace.json to save the trace." << endl;
+            }
+
+            // Si la tecla presionada es el ESC, entonces rompemos el ciclo y terminara el programa (excepto durante la búsqueda,
+            // donde ESC solo la cancela)
+            if (event.keyboard.keycode == ALLEGRO_KEY_ESCAPE && current_phase != SEARCHING)
                 break;
 
             // Si al presionar una tecla seguimos estamos en la primera fase
@@ -619,8 +1484,10 @@ int main()
                     if (selected_input_field == 0)
                         // Entonces aumentamos nuestro contador
                         num_missionaries_input++;
-                    else
+                    else if (selected_input_field == 1)
                         num_cannibals_input++;
+                    else
+                        boat_capacity_input = min(MAX_BOAT_CAPACITY, boat_capacity_input + 1);
                 }
                 // Si la tecla presionada es flecha abajo
                 else if (event.keyboard.keycode == ALLEGRO_KEY_DOWN)
@@ -631,37 +1498,53 @@ int main()
                         // el valor actual de la variable, para que en caso de que si la variable llega a ser negativa (el usuario disminuyo
                         // muchas veces) entonces max simplemente agarrara 0 y la variable valdrá eso
                         num_missionaries_input = max(0, num_missionaries_input - 1);
-                    else
+                    else if (selected_input_field == 1)
                         num_cannibals_input = max(0, num_cannibals_input - 1);
+                    else
+                        // El bote siempre debe de poder llevar al menos a una persona
+                        boat_capacity_input = max(1, boat_capacity_input - 1);
+                }
+                // Si la tecla seleccionada es la flecha derecha, pasamos al siguiente campo (recordar que son valores entre 0 y 2)
+                else if (event.keyboard.keycode == ALLEGRO_KEY_RIGHT)
+                {
+                    selected_input_field = (selected_input_field + 1) % 3;
                 }
-                // Si la tecla seleccionada es la flecha derecha o izquierda
-                else if (event.keyboard.keycode == ALLEGRO_KEY_LEFT || event.keyboard.keycode == ALLEGRO_KEY_RIGHT)
+                // Si es la flecha izquierda, regresamos al campo anterior
+                else if (event.keyboard.keycode == ALLEGRO_KEY_LEFT)
                 {
-                    // Cambiamos el input seleccionado (recordar que son valores entre 0 y 1)
-                    selected_input_field = 1 - selected_input_field;
+                    selected_input_field = (selected_input_field + 2) % 3;
+                }
+                // Si la tecla seleccionada es TAB, pasamos al siguiente algoritmo (DFS, BFS, bidireccional, A*)
+                else if (event.keyboard.keycode == ALLEGRO_KEY_TAB)
+                {
+                    selected_algorithm = (SolverAlgorithm)((selected_algorithm + 1) % ALGORITHM_COUNT);
                 }
                 // Si la tecla seleccionada es enter
                 else if (event.keyboard.keycode == ALLEGRO_KEY_ENTER)
                 {
                     // Solo por buena practica, limpiamos nuestro vector antes de resolver el problema
                     solution_path.clear();
-                    // Nuevamente por buena practica, limpiamos nuestras variables
-                    current_solution_step = 0;
-                    time_since_last_step = 0;
-                    boat_animation_progress = 0.0f;
-
-                    // Llamamos a nuestra función para resolver el problema de misioneros y caníbales manando la información de este, asi como
-                    // el vector que va a representar nuestra solución
-                    if (solve_mc(num_missionaries_input, num_cannibals_input, solution_path))
-                    {
-                        // Dado que la situación inicial es valida, entonces cambiamos la fase
-                        current_phase = SOLVING;
-                    }
-                    // Si no hay una situación inicial valida, entonces cambiamos la fase
-                    else
-                    {
-                        current_phase = NO_SOLUTION;
-                    }
+                    shortest_browser.index = 0;
+
+                    // Empezamos a resolver el problema de misioneros y caníbales en otro hilo y cambiamos a la fase de búsqueda, cuando
+                    // el hilo termine el ciclo de eventos pasara a SOLVING o a NO_SOLUTION según el resultado, si el problema ya esta en
+                    // el cache pasamos directo a esas fases
+                    current_phase = begin_solve(solution_cache, background_solve, num_missionaries_input, num_cannibals_input, boat_capacity_input,
+                                                selected_algorithm, solution_path, last_solve_stats);
+                    // Si salió del cache el camino ya esta completo (si se busca, se vuelve a empezar al terminar la búsqueda)
+                    reset_playback(playback, solution_path.size());
+                    last_solve_cached = current_phase != SEARCHING;
+                    if (last_solve_cached)
+                        last_solve_seconds = 0;
+                }
+            }
+            // Mientras se busca la solución, R o ESC cancelan la búsqueda y regresan al menu, cualquier otra tecla se ignora
+            else if (current_phase == SEARCHING)
+            {
+                if (event.keyboard.keycode == ALLEGRO_KEY_R || event.keyboard.keycode == ALLEGRO_KEY_ESCAPE)
+                {
+                    cancel_background_solve(background_solve);
+                    current_phase = KEYBOARD_INPUT;
                 }
             }
             // Si no estamos en la primera fase y se presiona una tecla
@@ -670,14 +1553,37 @@ int main()
                 // Si esta es la tecla de flecha arriba
                 if (event.keyboard.keycode == ALLEGRO_KEY_UP)
                 {
-                    // Aumentamos la velocidad de simulación en un 0.5, utilizando min para tener un tope hasta 10
-                    simulation_speed = min(10.0f, simulation_speed + 0.5f);
+                    // Pasamos a la siguiente velocidad de la tabla, utilizando min para tener un tope en la ultima (1000x)
+                    playback.speed_index = min(playback_speed_count - 1, playback.speed_index + 1);
                 }
                 // Si la tecla es flecha abajo
                 else if (event.keyboard.keycode == ALLEGRO_KEY_DOWN)
                 {
-                    // Disminuimos la velocidad en 0.5, utilizando max para tener un tope hasta 0.5
-                    simulation_speed = max(0.5f, simulation_speed - 0.5f);
+                    // Regresamos a la velocidad anterior, utilizando max para tener un tope en la primera (0.5x)
+                    playback.speed_index = max(0, playback.speed_index - 1);
+                }
+                // Las flechas izquierda y derecha saltan un paso, AvPag y RePag un 10% del camino, e Inicio y Fin a los extremos, en
+                // todos los casos la animación sigue desde ahi
+                else if (event.keyboard.keycode == ALLEGRO_KEY_LEFT || event.keyboard.keycode == ALLEGRO_KEY_RIGHT ||
+                         event.keyboard.keycode == ALLEGRO_KEY_PGUP || event.keyboard.keycode == ALLEGRO_KEY_PGDN ||
+                         event.keyboard.keycode == ALLEGRO_KEY_HOME || event.keyboard.keycode == ALLEGRO_KEY_END)
+                {
+                    double step = (double)playback_step(playback);
+                    double jump = max(1.0, floor(playback.steps / 10.0));
+                    if (event.keyboard.keycode == ALLEGRO_KEY_LEFT)
+                        step -= 1;
+                    else if (event.keyboard.keycode == ALLEGRO_KEY_RIGHT)
+                        step += 1;
+                    else if (event.keyboard.keycode == ALLEGRO_KEY_PGUP)
+                        step -= jump;
+                    else if (event.keyboard.keycode == ALLEGRO_KEY_PGDN)
+                        step += jump;
+                    else if (event.keyboard.keycode == ALLEGRO_KEY_HOME)
+                        step = 0;
+                    else
+                        step = (double)playback.steps;
+                    seek_playback(playback, step);
+                    current_phase = SOLVING;
                 }
                 // Si se presiona R, regresar al menú principal
                 else if (event.keyboard.keycode == ALLEGRO_KEY_R)
@@ -686,30 +1592,35 @@ int main()
                     current_phase = KEYBOARD_INPUT;
                     // Limpiamos la solución actual
                     solution_path.clear();
-                    // Reiniciamos variables de control de animación
-                    current_solution_step = 0;
-                    time_since_last_step = 0;
-                    boat_animation_progress = 0.0f;
-                    // Reiniciamos la velocidad de simulación
-                    simulation_speed = 1.0f;
+                    // Reiniciamos la animación (posición y velocidad)
+                    reset_playback(playback, 0);
                 }
                 // Si se presiona ESPACIO, reiniciar la simulación con los mismos valores
                 else if (event.keyboard.keycode == ALLEGRO_KEY_SPACE)
                 {
                     // Limpiamos la solución actual
                     solution_path.clear();
-                    // Reiniciamos variables de control
-                    current_solution_step = 0;
-                    time_since_last_step = 0;
-                    boat_animation_progress = 0.0f;
-                    // Reiniciamos la velocidad de simulación
-                    simulation_speed = 1.0f;
-
-                    // Volvemos a resolver el problema con los mismos valores
-                    solve_mc(num_missionaries_input, num_cannibals_input, solution_path);
-
-                    // Cambiamos la fase
-                    current_phase = SOLVING;
+                    shortest_browser.index = 0;
+
+                    // Volvemos a resolver el problema con los mismos valores, igual que con ENTER, como ya se resolvió normalmente sale
+                    // del cache sin volver a buscar
+                    current_phase = begin_solve(solution_cache, background_solve, num_missionaries_input, num_cannibals_input, boat_capacity_input,
+                                                selected_algorithm, solution_path, last_solve_stats);
+                    // Si salió del cache el camino ya esta completo (si se busca, se vuelve a empezar al terminar la búsqueda)
+                    reset_playback(playback, solution_path.size());
+                    last_solve_cached = current_phase != SEARCHING;
+                    if (last_solve_cached)
+                        last_solve_seconds = 0;
+                }
+                // N y P cambian a la siguiente o a la anterior de las soluciones mas cortas y la animan desde el inicio
+                else if (event.keyboard.keycode == ALLEGRO_KEY_N || event.keyboard.keycode == ALLEGRO_KEY_P)
+                {
+                    int direction = event.keyboard.keycode == ALLEGRO_KEY_N ? 1 : -1;
+                    if (browse_shortest(shortest_browser, num_missionaries_input, num_cannibals_input, boat_capacity_input, direction, solution_path))
+                    {
+                        current_phase = SOLVING;
+                        reset_playback(playback, solution_path.size());
+                    }
                 }
             }
             // Si estamos en la fase NO_SOLUTION y se presiona una tecla
@@ -722,28 +1633,51 @@ int main()
                     current_phase = KEYBOARD_INPUT;
                     // Limpiamos variables
                     solution_path.clear();
-                    current_solution_step = 0;
-                    time_since_last_step = 0;
-                    boat_animation_progress = 0.0f;
-                    simulation_speed = 1.0f;
+                    reset_playback(playback, 0);
                 }
             }
         }
 
+        // En el menu la vista previa se actualiza en cuanto se cambia un valor, sin esperar al siguiente tick (que puede no llegar
+        // si el temporizador esta detenido)
+        if (current_phase == KEYBOARD_INPUT && event.type == ALLEGRO_EVENT_KEY_DOWN)
+            update_menu_preview(menu_preview, num_missionaries_input, num_cannibals_input, boat_capacity_input);
+
+        // El temporizador solo hace falta mientras algo cambia sin que el usuario haga nada: la animación, la búsqueda en otro hilo,
+        // la búsqueda de la vista previa del menu o el guardado de los resultados (cambia el texto de SOLVED). En las demás
+        // pantallas lo detenemos y el ciclo se queda dormido en al_wait_for_event hasta la siguiente tecla, sin usar el procesador
+        bool needs_ticks = current_phase == SOLVING || current_phase == SEARCHING ||
+                           (current_phase == KEYBOARD_INPUT && menu_preview.searching) ||
+                           (current_phase == SOLVED && !results_writer.done.load());
+        if (needs_ticks && !al_get_timer_started(timer))
+            al_start_timer(timer);
+        else if (!needs_ticks && al_get_timer_started(timer))
+            al_stop_timer(timer);
+
         // Si la variable redibujar es verdadera y no hay ningún evento a procesar (la cola de eventos esta vacía)
         if (redraw && al_is_event_queue_empty(event_queue))
         {
+            // Medimos cuanto tarda en dibujarse este frame
+            double frame_start_us = profiler.now_us();
+            frame_draw_calls = 1;
+#ifdef MC_DEBUG_ALLOCS
+            long long frame_start_allocations = debug_allocations;
+#endif
+
             // Limpiamos la pantalla con el color negro (nuestro fondo)
-            al_clear_to_color(al_map_rgb(0, 0, 0));
+            al_clear_to_color(palette.black);
 
             // Si al limpiar la pantalla estamos en la primera fase
             if (current_phase == KEYBOARD_INPUT)
             {
-                // Creamos variables stringstream, ver https://shorturl.at/V98Mm
-                stringstream m_text, c_text;
-                // Usando estas variables, guardamos el mensaje junto con su valor
-                m_text << "Missionaries: " << num_missionaries_input;
-                c_text << "Cannibals: " << num_cannibals_input;
+                // Formateamos el mensaje de cada campo junto con su valor en un texto fijo de hud, ver https://cplusplus.com/reference/cstdio/snprintf/,
+                // solo cuando el valor cambia, en los demás frames se vuelve a dibujar el mismo texto
+                if (hud_text_stale(hud.missionaries, num_missionaries_input))
+                    snprintf(hud.missionaries.text, sizeof(hud.missionaries.text), "Missionaries: %d", num_missionaries_input);
+                if (hud_text_stale(hud.cannibals, num_cannibals_input))
+                    snprintf(hud.cannibals.text, sizeof(hud.cannibals.text), "Cannibals: %d", num_cannibals_input);
+                if (hud_text_stale(hud.capacity, boat_capacity_input))
+                    snprintf(hud.capacity.text, sizeof(hud.capacity.text), "Boat capacity: %d", boat_capacity_input);
 
                 // Imprimimos el mensaje que va a estar arriba, esta función tiene los siguientes parámetros:
                 // - Fuente a usar
@@ -753,109 +1687,183 @@ int main()
                 // - ALLEGRO_ALIGN_CENTRE esta definido en la librería <allegro5/allegro_font.h>, por lo que en realidad vale 1, y esto ayuda que el texto
                 // este centrado en esas coordenadas
                 // - Texto que se va a mostrar
-                al_draw_text(font, al_map_rgb(255, 255, 255), screen_width / 2, screen_height / 2 - 60, ALLEGRO_ALIGN_CENTRE, "Set Initial Numbers");
+                draw_text(font, palette.white, screen_width / 2, screen_height / 2 - 60, ALLEGRO_ALIGN_CENTRE, "Set Initial Numbers");
+
+                // Declaramos variables de tipo color para las opciones, el campo seleccionado va a ser de color amarillo y los
+                // demás blancos
+                ALLEGRO_COLOR selected_color = palette.highlight;
+                ALLEGRO_COLOR normal_color = palette.white;
+                ALLEGRO_COLOR m_color = selected_input_field == 0 ? selected_color : normal_color;
+                ALLEGRO_COLOR c_color = selected_input_field == 1 ? selected_color : normal_color;
+                ALLEGRO_COLOR k_color = selected_input_field == 2 ? selected_color : normal_color;
+
+                // Imprimimos las opciones en pantalla, el texto de cada una ya es un arreglo de char, que es lo que la función
+                // al_draw_text recibe como char const *text (checa definición de la función)
+                draw_text(font, m_color, screen_width / 2, screen_height / 2 - 30, ALLEGRO_ALIGN_CENTRE, hud.missionaries.text);
+                draw_text(font, c_color, screen_width / 2, screen_height / 2 - 10, ALLEGRO_ALIGN_CENTRE, hud.cannibals.text);
+                draw_text(font, k_color, screen_width / 2, screen_height / 2 + 10, ALLEGRO_ALIGN_CENTRE, hud.capacity.text);
+
+                // Mostramos el algoritmo con el que se va a resolver
+                if (hud_text_stale(hud.algorithm, selected_algorithm))
+                    snprintf(hud.algorithm.text, sizeof(hud.algorithm.text), "Algorithm: %s", algorithm_name(selected_algorithm));
+                draw_text(font, palette.white, screen_width / 2, screen_height / 2 + 30, ALLEGRO_ALIGN_CENTRE, hud.algorithm.text);
 
-                // Declaramos variables de tipo color para las opciones
-                ALLEGRO_COLOR m_color, c_color;
-                // Si el campo seleccionado es el primero, entonces este va a ser de color amarillo
-                if (selected_input_field == 0)
-                {
-                    m_color = al_map_rgb(255, 255, 0);
-                    c_color = al_map_rgb(255, 255, 255);
-                }
-                else
+                // Imprimimos mensajes de información un poco mas abajo de las opciones
+                draw_text(font, palette.hint_text, screen_width / 2, screen_height / 2 + 60, ALLEGRO_ALIGN_CENTRE, "Use UP/DOWN to change, LEFT/RIGHT to select, TAB for algorithm");
+                draw_text(font, palette.hint_text, screen_width / 2, screen_height / 2 + 80, ALLEGRO_ALIGN_CENTRE, "Press ENTER to Start Simulation");
+
+                // Vista previa: si tiene solución y cuantos movimientos tiene la mas corta
+                if (hud_text_stale(hud.preview, menu_preview.solvable, menu_preview.moves))
                 {
-                    m_color = al_map_rgb(255, 255, 255);
-                    c_color = al_map_rgb(255, 255, 0);
+                    if (!menu_preview.solvable)
+                        snprintf(hud.preview.text, sizeof(hud.preview.text), "Preview: no solution");
+                    else if (menu_preview.moves < 0)
+                        snprintf(hud.preview.text, sizeof(hud.preview.text), "Preview: solvable, counting moves...");
+                    else
+                        snprintf(hud.preview.text, sizeof(hud.preview.text), "Preview: solvable, shortest solution %lld moves", menu_preview.moves);
                 }
-
-                // Imprimimos las opciones en pantalla, obteniendo la cadena de m_text usando .str() y su apuntador como constante, esto ya que la función
-                // al_draw_text utiliza el texto como char const *text (checa definición de la función)
-                al_draw_text(font, m_color, screen_width / 2, screen_height / 2 - 20, ALLEGRO_ALIGN_CENTRE, m_text.str().c_str());
-                al_draw_text(font, c_color, screen_width / 2, screen_height / 2 + 20, ALLEGRO_ALIGN_CENTRE, c_text.str().c_str());
-
-                // Imprimimos mensajes de información un poco mas abajo de las opciones
-                al_draw_text(font, al_map_rgb(180, 180, 180), screen_width / 2, screen_height / 2 + 60, ALLEGRO_ALIGN_CENTRE, "Use UP/DOWN to change, LEFT/RIGHT to select");
-                al_draw_text(font, al_map_rgb(180, 180, 180), screen_width / 2, screen_height / 2 + 80, ALLEGRO_ALIGN_CENTRE, "Press ENTER to Start Simulation");
+                draw_text(font, menu_preview.solvable ? palette.success : palette.error, screen_width / 2, screen_height / 2 + 110,
+                          ALLEGRO_ALIGN_CENTRE, hud.preview.text);
             }
             // Si estamos en alguna de las fases SOLVING o SOLVED, es decir, mostrando la animación o el resultado final
             else if (current_phase == SOLVING || current_phase == SOLVED)
             {
                 // Primero, verificamos si hay una solución cargada y si el paso actual es válido dentro de esa solución
-                if (!solution_path.empty() && current_solution_step < solution_path.size())
+                if (!solution_path.empty() && current_phase == SOLVING)
                 {
-                    // Obtenemos el estado que se va a dibujar del vector de la solución
+                    // Obtenemos el paso que se va a dibujar y el estado que le corresponde en el vector de la solución
+                    size_t current_solution_step = playback_step(playback);
                     State s_to_draw = solution_path[current_solution_step];
                     // Inicializamos un puntero al estado previo como nulo por defecto
                     const State *param_prev_s = nullptr;
                     // El progreso de la animación para draw_state será el progreso actual del bote
-                    float param_anim = boat_animation_progress;
+                    float param_anim = playback_progress(playback, 1.0 / 60.0);
 
-                    // Si estamos activamente resolviendo (animando) y no es el primer paso de la solución
-                    if (current_phase == SOLVING && current_solution_step > 0)
-                    {
-                        // Solo consideramos el estado previo si el bote está efectivamente en tránsito,
-                        // es decir, el progreso de la animación es mayor a 0 y menor a 1
-                        if (boat_animation_progress > 0.0f && boat_animation_progress < 1.0f)
-                        {
-                            // Asignamos la dirección del estado anterior para la interpolación del dibujo
-                            param_prev_s = &solution_path[current_solution_step - 1];
-                        }
-                    }
-                    // Si la fase es SOLVED, significa que la animación ha terminado
-                    else if (current_phase == SOLVED)
+                    // Si no es el primer paso de la solución, solo consideramos el estado previo si el bote está efectivamente en
+                    // tránsito, es decir, el progreso de la animación es mayor a 0 y menor a 1
+                    if (current_solution_step > 0 && param_anim > 0.0f && param_anim < 1.0f)
                     {
-                        // Forzamos el parámetro de animación a 0 para asegurar que el bote se dibuje parado
-                        param_anim = 0.0f;
+                        // Asignamos la dirección del estado anterior para la interpolación del dibujo
+                        param_prev_s = &solution_path[current_solution_step - 1];
                     }
 
                     // Llamamos a la función principal de dibujo con el estado actual, el previo (si existe),
                     // los números iniciales, la fuente y el progreso de la animación del bote
-                    draw_state(s_to_draw, param_prev_s, num_missionaries_input, num_cannibals_input, font, param_anim);
+                    draw_state(s_to_draw, param_prev_s, num_missionaries_input, num_cannibals_input, font, param_anim, scene_cache, sprite_atlas);
                 }
                 // Si la condición anterior no se cumple, pero estamos en SOLVED y hay solución,
-                // esto cubre el caso de dibujar el estado final estáticamente después de que la animación ha concluido,
-                // o si por alguna razón current_solution_step no fuera menor a solution_path.size(), pero sí es el último estado
+                // esto cubre el caso de dibujar el estado final estáticamente después de que la animación ha concluido
                 else if (current_phase == SOLVED && !solution_path.empty())
                 {
                     // Dibujamos el último estado de la solución de forma estática, sin animación del bote
-                    draw_state(solution_path.back(), nullptr, num_missionaries_input, num_cannibals_input, font, 0.0f);
+                    draw_state(solution_path.back(), nullptr, num_missionaries_input, num_cannibals_input, font, 0.0f, scene_cache, sprite_atlas);
                     // Mostramos el mensaje de "SOLUTION FOUND!"
-                    al_draw_text(font, al_map_rgb(0, 255, 0), screen_width / 2, screen_height / 2 - 20, ALLEGRO_ALIGN_CENTRE, "SOLUTION FOUND!");
+                    draw_text(font, palette.success, screen_width / 2, screen_height / 2 - 20, ALLEGRO_ALIGN_CENTRE, "SOLUTION FOUND!");
                 }
 
                 // Preparamos y mostramos el mensaje de control de velocidad de la simulación
-                stringstream speed_msg;
-                speed_msg << "Speed: " << simulation_speed << "x (UP/DOWN to change)";
-                al_draw_text(font, al_map_rgb(200, 200, 200), 10, 10, ALLEGRO_ALIGN_LEFT, speed_msg.str().c_str());
+                if (hud_text_stale(hud.speed, playback.speed_index))
+                    snprintf(hud.speed.text, sizeof(hud.speed.text), "Speed: %gx (UP/DOWN) | Seek: LEFT/RIGHT, PGUP/PGDN, HOME/END or the bar",
+                             playback_speed(playback));
+                draw_text(font, palette.info_text, 10, 10, ALLEGRO_ALIGN_LEFT, hud.speed.text);
 
                 // Mostramos los controles disponibles
-                al_draw_text(font, al_map_rgb(180, 180, 180), 10, 30, ALLEGRO_ALIGN_LEFT, "R - Back to menu | SPACE - Restart simulation");
+                draw_text(font, palette.hint_text, 10, 30, ALLEGRO_ALIGN_LEFT, "R - Back to menu | SPACE - Restart simulation");
+
+                // Mostramos cuantos estados expandió el algoritmo y cuantos movimientos tiene la solución, para comparar DFS contra BFS
+                long long moves = solution_path.empty() ? 0 : (long long)solution_path.size() - 1;
+                if (hud_text_stale(hud.stats, selected_algorithm, last_solve_stats.states_expanded, moves, last_solve_cached))
+                    snprintf(hud.stats.text, sizeof(hud.stats.text), "%s: %lld states expanded, %lld moves%s", algorithm_name(selected_algorithm),
+                             last_solve_stats.states_expanded, moves, last_solve_cached ? " (cached)" : "");
+                draw_text(font, palette.hint_text, 10, 50, ALLEGRO_ALIGN_LEFT, hud.stats.text);
+
+                // Mostramos cual de las soluciones mas cortas se esta viendo, o como recorrerlas
+                bool browse_too_large = shortest_browser.too_large && shortest_browser.built_m == num_missionaries_input &&
+                                        shortest_browser.built_c == num_cannibals_input && shortest_browser.built_k == boat_capacity_input;
+                if (hud_text_stale(hud.shortest, shortest_browser.index, browse_too_large, shortest_browser.built_m, shortest_browser.built_c,
+                                   shortest_browser.built_k))
+                {
+                    if (shortest_browser.index > 0)
+                        snprintf(hud.shortest.text, sizeof(hud.shortest.text), "Shortest solution %lld of %s (N/P to change)", shortest_browser.index,
+                                 shortest_browser.count_text.c_str());
+                    else if (browse_too_large)
+                        snprintf(hud.shortest.text, sizeof(hud.shortest.text), "Too many states to browse the shortest solutions");
+                    else
+                        snprintf(hud.shortest.text, sizeof(hud.shortest.text), "N/P - Browse the shortest solutions");
+                }
+                draw_text(font, palette.hint_text, 10, 70, ALLEGRO_ALIGN_LEFT, hud.shortest.text);
+
+                // Barra de la reproducción con el paso actual
+                if (!solution_path.empty())
+                    draw_scrub_bar(playback, font);
 
                 // Si la simulación ha sido completada y estamos en la fase SOLVED
                 if (current_phase == SOLVED)
                 {
                     // Mostramos un mensaje indicando que la simulación está completa y cómo salir
-                    al_draw_text(font, al_map_rgb(0, 255, 0), screen_width / 2, screen_height - 60, ALLEGRO_ALIGN_CENTRE, "Simulation Complete. Press ESC to exit");
-                    al_draw_text(font, al_map_rgb(180, 180, 180), screen_width / 2, screen_height - 40, ALLEGRO_ALIGN_CENTRE, "Results saved in results.txt");
-                    al_draw_text(font, al_map_rgb(255, 255, 0), screen_width / 2, screen_height - 20, ALLEGRO_ALIGN_CENTRE, "R - Menu | SPACE - Restart | ESC - Exit");
+                    draw_text(font, palette.success, screen_width / 2, screen_height - 60, ALLEGRO_ALIGN_CENTRE, "Simulation Complete. Press ESC to exit");
+                    bool results_saved = results_writer.done.load();
+                    if (hud_text_stale(hud.saved, results_saved, results_format))
+                        snprintf(hud.saved.text, sizeof(hud.saved.text), "%s%s", results_saved ? "Results saved in " : "Saving results to ",
+                                 results_file_name(results_format));
+                    draw_text(font, palette.hint_text, screen_width / 2, screen_height - 40, ALLEGRO_ALIGN_CENTRE, hud.saved.text);
+                    draw_text(font, palette.highlight, screen_width / 2, screen_height - 20, ALLEGRO_ALIGN_CENTRE, "R - Menu | SPACE - Restart | ESC - Exit");
                 }
             }
+            // Si estamos buscando la solución en otro hilo, mostramos cuantos estados se han explorado hasta ahora
+            else if (current_phase == SEARCHING)
+            {
+                long long states_explored = background_solve.control.states_explored.load();
+                if (hud_text_stale(hud.progress, states_explored, selected_algorithm))
+                    snprintf(hud.progress.text, sizeof(hud.progress.text), "States explored: %lld (%s)", states_explored,
+                             algorithm_name(selected_algorithm));
+
+                draw_text(font, palette.highlight, screen_width / 2, screen_height / 2 - 20, ALLEGRO_ALIGN_CENTRE, "SOLVING...");
+                draw_text(font, palette.white, screen_width / 2, screen_height / 2, ALLEGRO_ALIGN_CENTRE, hud.progress.text);
+                draw_text(font, palette.hint_text, screen_width / 2, screen_height - 40, ALLEGRO_ALIGN_CENTRE, "R or ESC - Cancel");
+            }
             // Si estamos en esta fase ya que no se encontró solucion al problema
             else if (current_phase == NO_SOLUTION)
             {
                 // Simplemente mostramos mensajes informativos
-                al_draw_text(font, al_map_rgb(255, 0, 0), screen_width / 2, screen_height / 2, ALLEGRO_ALIGN_CENTRE, "NO SOLUTION FOUND for these values.");
-                al_draw_text(font, al_map_rgb(180, 180, 180), screen_width / 2, screen_height - 40, ALLEGRO_ALIGN_CENTRE, "Press ESC to exit | R - Menu ");
+                draw_text(font, palette.error, screen_width / 2, screen_height / 2, ALLEGRO_ALIGN_CENTRE, "NO SOLUTION FOUND for these values.");
+                draw_text(font, palette.hint_text, screen_width / 2, screen_height - 40, ALLEGRO_ALIGN_CENTRE, "Press ESC to exit | R - Menu ");
             }
 
+            // El panel de instrumentación va encima de todo lo demás
+            if (show_profiler)
+                draw_profiler_overlay(profiler, font, last_solve_seconds, last_solve_stats.states_expanded, selected_algorithm);
+
             // Esta función actualiza la pantalla tras los cambios realizados
             al_flip_display();
+
+#ifdef MC_DEBUG_ALLOCS
+            // En un frame estable (la misma fase que el frame anterior) dibujar no debe de reservar memoria
+            assert(current_phase != last_drawn_phase || debug_allocations == frame_start_allocations);
+            last_drawn_phase = current_phase;
+#endif
+
+            // Guardamos el frame, si llego mas de un tick del temporizador desde el frame anterior, los demás no se dibujaron
+            profiler.add_frame(frame_start_us, profiler.now_us(), frame_draw_calls, events_since_frame, max(0, timer_ticks_since_frame - 1));
+            events_since_frame = 0;
+            timer_ticks_since_frame = 0;
             // Al haber hecho una actualización en pantalla, no volvemos dibujar
             redraw = false;
         }
     }
 
+    // Si se cerro la ventana mientras se buscaba la solución, detenemos el hilo antes de salir, y si aun se estaban guardando
+    // los resultados esperamos a que terminen
+    cancel_background_solve(background_solve);
+    finish_results_write(results_writer);
+
+    // Guardamos el cache para la próxima vez que se abra el programa
+    ofstream cache_file(DEFAULT_CACHE_FILE, ios::binary);
+    if (!cache_file.is_open() || !solution_cache.save(cache_file))
+        cerr << "Error: Could not save the cache in " << DEFAULT_CACHE_FILE << "." << endl;
+
+    destroy_scene_cache(scene_cache);
+    destroy_sprite_atlas(sprite_atlas);
     al_destroy_font(font);
     al_destroy_display(display);
     al_destroy_timer(timer);
@@ -0,0 +1,366 @@
+// Todas las soluciones mas cortas de un problema: se construye una sola vez el grafo (DAG) de los caminos mas cortos, con el
+// se cuentan cuantas soluciones distintas hay (un numero que crece muy rápido, por eso se guarda en un entero de tamaño
+// arbitrario) y se recorren una por una sin tener que guardarlas todas en memoria
+#ifndef OPTIMAL_PATHS_H
+#define OPTIMAL_PATHS_H
+
+#include "solver.h"
+// Librerías estándar de c++
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdio>
+
+using namespace std;
+
+// Entero sin signo de tamaño arbitrario, solo con lo que hace falta para contar caminos (sumar e imprimir), se guarda en
+// bloques de 9 dígitos decimales (base 10^9) del menos significativo al mas significativo, asi imprimirlo es directo
+struct BigCount
+{
+    static const uint32_t BASE = 1000000000;
+    vector<uint32_t> limbs;
+
+    void set(uint32_t value)
+    {
+        limbs.clear();
+        if (value >= BASE)
+        {
+            limbs.push_back(value % BASE);
+            value /= BASE;
+        }
+        if (value > 0)
+            limbs.push_back(value);
+    }
+
+    bool is_zero() const
+    {
+        return limbs.empty();
+    }
+
+    void add(const BigCount &other)
+    {
+        if (other.limbs.size() > limbs.size())
+            limbs.resize(other.limbs.size(), 0);
+        uint32_t carry = 0;
+        for (size_t i = 0; i < limbs.size(); ++i)
+        {
+            uint64_t sum = uint64_t(limbs[i]) + carry + (i < other.limbs.size() ? other.limbs[i] : 0);
+            limbs[i] = uint32_t(sum % BASE);
+            carry = uint32_t(sum / BASE);
+            if (carry == 0 && i >= other.limbs.size())
+                break;
+        }
+        if (carry > 0)
+            limbs.push_back(carry);
+    }
+
+    string to_string() const
+    {
+        if (limbs.empty())
+            return "0";
+        char block[16];
+        snprintf(block, sizeof(block), "%u", limbs.back());
+        string text = block;
+        for (size_t i = limbs.size() - 1; i-- > 0;)
+        {
+            snprintf(block, sizeof(block), "%09u", limbs[i]);
+            text += block;
+        }
+        return text;
+    }
+};
+
+// Distancia de un estado que aun no se alcanza
+const uint32_t UNREACHED = UINT32_MAX;
+
+// Grafo de los caminos mas cortos: con un BFS desde el estado inicial y otro desde la solución se obtiene la distancia de cada
+// estado a ambos extremos, un estado esta en algún camino mas corto si la suma de sus 2 distancias es la longitud del camino
+// mas corto, y un movimiento es parte de un camino mas corto si avanza uno hacia la solución en ambas distancias. No se guardan
+// las aristas, se vuelven a calcular con la tabla de movimientos cuando se necesitan
+struct ShortestPathDag
+{
+    int total_m, total_c, boat_capacity;
+    vector<BoatLoad> moves;
+    // Solo se usa para calcular la posición de cada estado en las tablas de distancias
+    VisitedTable table;
+    vector<uint32_t> from_start, to_goal;
+    State initial_s, goal_s;
+    // Movimientos de las soluciones mas cortas, o -1 si no hay solución
+    long long length;
+
+    // Construye el grafo, devuelve false si el problema no tiene solución o si tiene mas de max_states estados posibles
+    // (0 para no poner limite), las tablas ocupan 8 bytes por estado
+    bool build(int m, int c, int capacity, size_t max_states = 0)
+    {
+        total_m = m;
+        total_c = c;
+        boat_capacity = capacity;
+        length = -1;
+        initial_s = State::make(total_m, total_c, 0);
+        goal_s = State::make(0, 0, 1);
+        if (!is_valid(initial_s, total_m, total_c) || !is_solvable(total_m, total_c, boat_capacity))
+            return false;
+
+        moves = build_move_table(boat_capacity);
+        table.reset(total_m, total_c);
+        if (max_states > 0 && table.size() > max_states)
+            return false;
+
+        // Desde el inicio basta con llegar a la solución, desde la solución no hace falta ir mas lejos que la longitud del
+        // camino, ya que ningún estado mas lejano puede estar en un camino mas corto
+        bfs_distances(initial_s, goal_s, UNREACHED, from_start);
+        length = from_start[table.index(goal_s)] == UNREACHED ? -1 : (long long)from_start[table.index(goal_s)];
+        if (length < 0)
+            return false;
+        bfs_distances(goal_s, initial_s, (uint32_t)length, to_goal);
+        return true;
+    }
+
+    // BFS desde origin guardando la distancia de cada estado, se detiene al terminar el nivel donde aparece target o al llegar
+    // a max_depth
+    void bfs_distances(const State &origin, const State &target, uint32_t max_depth, vector<uint32_t> &distance) const
+    {
+        distance.assign(table.size(), UNREACHED);
+        vector<State> frontier(1, origin);
+        distance[table.index(origin)] = 0;
+        size_t head = 0;
+        while (head < frontier.size())
+        {
+            State current_s = frontier[head++];
+            uint32_t current_d = distance[table.index(current_s)];
+            if (current_d >= max_depth || distance[table.index(target)] < current_d)
+                break;
+            for (size_t i = 0; i < moves.size(); ++i)
+            {
+                State next_s;
+                if (!apply_move(current_s, moves[i].m, moves[i].c, total_m, total_c, next_s) || !is_valid(next_s, total_m, total_c))
+                    continue;
+                size_t next_index = table.index(next_s);
+                if (distance[next_index] != UNREACHED)
+                    continue;
+                distance[next_index] = current_d + 1;
+                frontier.push_back(next_s);
+            }
+        }
+    }
+
+    // Busca desde la posición first de la tabla de movimientos el siguiente movimiento de s que sigue en un camino mas corto,
+    // devuelve su indice (o moves.size() si ya no hay) y el estado al que lleva en next_s
+    size_t next_edge(const State &s, size_t first, State &next_s) const
+    {
+        size_t s_index = table.index(s);
+        if (to_goal[s_index] == 0)
+            return moves.size();
+        uint32_t next_start = from_start[s_index] + 1, next_goal = to_goal[s_index] - 1;
+        for (size_t i = first; i < moves.size(); ++i)
+        {
+            if (!apply_move(s, moves[i].m, moves[i].c, total_m, total_c, next_s) || !is_valid(next_s, total_m, total_c))
+                continue;
+            size_t next_index = table.index(next_s);
+            if (from_start[next_index] == next_start && to_goal[next_index] == next_goal)
+                return i;
+        }
+        return moves.size();
+    }
+
+    // Igual que next_edge pero hacia atrás en la tabla de movimientos: busca el ultimo movimiento antes de la posición before
+    // que sigue en un camino mas corto (moves.size() como before para buscar en toda la tabla)
+    size_t previous_edge(const State &s, size_t before, State &next_s) const
+    {
+        size_t s_index = table.index(s);
+        if (to_goal[s_index] == 0)
+            return moves.size();
+        uint32_t next_start = from_start[s_index] + 1, next_goal = to_goal[s_index] - 1;
+        for (size_t i = before; i-- > 0;)
+        {
+            if (!apply_move(s, moves[i].m, moves[i].c, total_m, total_c, next_s) || !is_valid(next_s, total_m, total_c))
+                continue;
+            size_t next_index = table.index(next_s);
+            if (from_start[next_index] == next_start && to_goal[next_index] == next_goal)
+                return i;
+        }
+        return moves.size();
+    }
+
+    // Cuenta los caminos mas cortos con programación dinámica, nivel por nivel desde el inicio: los caminos que llegan a un
+    // estado son la suma de los que llegan a sus antecesores, solo se guardan los contadores de 2 niveles a la vez. El numero
+    // puede tener miles de dígitos y el costo crece con ellos, si max_limbs no es 0 se deja de contar en cuanto algún contador
+    // pasa de max_limbs bloques de 9 dígitos, marcando truncated y devolviendo ese contador (una cota inferior)
+    BigCount count_paths(size_t max_limbs = 0, bool *truncated = nullptr) const
+    {
+        if (truncated)
+            *truncated = false;
+        BigCount total;
+        if (length < 0)
+            return total;
+
+        vector<pair<State, BigCount> > level(1), next_level;
+        level[0].first = initial_s;
+        level[0].second.set(1);
+        unordered_map<uint64_t, size_t> position;
+        for (long long d = 0; d < length; ++d)
+        {
+            next_level.clear();
+            position.clear();
+            for (size_t j = 0; j < level.size(); ++j)
+            {
+                State next_s;
+                for (size_t i = next_edge(level[j].first, 0, next_s); i < moves.size(); i = next_edge(level[j].first, i + 1, next_s))
+                {
+                    auto found = position.find(next_s.bits);
+                    if (found == position.end())
+                    {
+                        position[next_s.bits] = next_level.size();
+                        next_level.push_back(make_pair(next_s, level[j].second));
+                    }
+                    else
+                    {
+                        BigCount &count = next_level[found->second].second;
+                        count.add(level[j].second);
+                        if (max_limbs > 0 && count.limbs.size() > max_limbs)
+                        {
+                            if (truncated)
+                                *truncated = true;
+                            return count;
+                        }
+                    }
+                }
+            }
+            level.swap(next_level);
+        }
+        // El ultimo nivel solo tiene la solución
+        return level.empty() ? total : level[0].second;
+    }
+
+    size_t memory_bytes() const
+    {
+        return table.memory_bytes() + (from_start.capacity() + to_goal.capacity()) * sizeof(uint32_t);
+    }
+};
+
+// Recorre los caminos mas cortos de un ShortestPathDag uno por uno, en el orden de la tabla de movimientos, es un DFS sobre el
+// grafo con la misma pila de marcos que DfsSearch, por lo que solo guarda el camino actual y cada solución cuesta lo mismo
+// que su longitud sin importar cuantas haya. Cada rama del grafo llega a la solución, asi que nunca se exploran callejones
+// sin salida
+struct ShortestPathEnumerator
+{
+    const ShortestPathDag *dag;
+    vector<DfsFrame> stack;
+    // Numero de soluciones entregadas hasta ahora
+    long long produced;
+    bool finished;
+
+    void start(const ShortestPathDag &dag_)
+    {
+        dag = &dag_;
+        stack.clear();
+        produced = 0;
+        finished = dag->length < 0;
+        if (!finished)
+        {
+            DfsFrame frame = {dag->initial_s, 0};
+            stack.push_back(frame);
+        }
+    }
+
+    // Copia a path (reemplazando su contenido) la siguiente solución, devuelve false si ya se entregaron todas
+    bool next(vector<State> &path)
+    {
+        // Si la ultima solución entregada sigue en la pila, quitamos la solución para continuar desde su estado anterior
+        if (!stack.empty() && stack.back().state == dag->goal_s)
+            stack.pop_back();
+
+        while (!finished)
+        {
+            if (stack.empty())
+            {
+                finished = true;
+                break;
+            }
+
+            DfsFrame &frame = stack.back();
+            if (frame.state == dag->goal_s)
+            {
+                path.clear();
+                for (size_t i = 0; i < stack.size(); ++i)
+                    path.push_back(stack[i].state);
+                produced++;
+                return true;
+            }
+
+            State next_s;
+            size_t move = dag->next_edge(frame.state, frame.next_move, next_s);
+            if (move == dag->moves.size())
+            {
+                stack.pop_back();
+                continue;
+            }
+            frame.next_move = (int)move + 1;
+            DfsFrame next_frame = {next_s, 0};
+            stack.push_back(next_frame);
+        }
+        return false;
+    }
+
+    // Copia a path la solución anterior a la ultima entregada, devuelve false (sin cambiar nada) si la ultima fue la primera.
+    // Se regresa por la pila hasta el primer marco que tenga un movimiento anterior al que tomo y desde ahí se baja siempre
+    // por el ultimo movimiento, asi cuesta lo mismo que avanzar y no hace falta volver a empezar el recorrido
+    bool previous(vector<State> &path)
+    {
+        if (produced <= 1 || stack.empty() || stack.back().state != dag->goal_s)
+            return false;
+        stack.pop_back();
+
+        while (!stack.empty())
+        {
+            DfsFrame &frame = stack.back();
+            State next_s;
+            size_t move = dag->previous_edge(frame.state, frame.next_move - 1, next_s);
+            if (move == dag->moves.size())
+            {
+                stack.pop_back();
+                continue;
+            }
+            frame.next_move = (int)move + 1;
+            DfsFrame next_frame = {next_s, 0};
+            stack.push_back(next_frame);
+            descend_last(path);
+            produced--;
+            return true;
+        }
+        // No pasa si produced es correcto, siempre hay una solución antes de la segunda
+        finished = true;
+        return false;
+    }
+
+    // Copia a path la ultima solución, count es el numero de soluciones (de ShortestPathDag::count_paths) para que produced
+    // siga siendo la posición de la solución entregada
+    bool last(vector<State> &path, long long count)
+    {
+        start(*dag);
+        if (finished)
+            return false;
+        descend_last(path);
+        produced = count;
+        return true;
+    }
+
+    // Baja desde el tope de la pila hasta la solución tomando siempre el ultimo movimiento, y copia el camino a path
+    void descend_last(vector<State> &path)
+    {
+        while (stack.back().state != dag->goal_s)
+        {
+            DfsFrame &frame = stack.back();
+            State next_s;
+            size_t move = dag->previous_edge(frame.state, dag->moves.size(), next_s);
+            frame.next_move = (int)move + 1;
+            DfsFrame next_frame = {next_s, 0};
+            stack.push_back(next_frame);
+        }
+        path.clear();
+        for (size_t i = 0; i < stack.size(); ++i)
+            path.push_back(stack[i].state);
+    }
+};
+
+#endif
@@ -0,0 +1,96 @@
+// Lector del formato binario de resultados (results.bin o mc_cli --format binary), convierte el camino de vuelta al formato de
+// texto de results.txt, o solo muestra la información del problema y el numero de pasos
+#include "solver.h"
+#include "results_io.h"
+// Librerías estándar de c++
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Muestra como se usa el programa
+void print_usage(const char *program)
+{
+    cerr << "Usage: " << program << " <results.bin> [-o results.txt] [--info]" << endl;
+    cerr << "  -o FILE    write the text to FILE instead of printing it" << endl;
+    cerr << "  --info     only print the problem and the number of moves" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    string input_file;
+    string output_file;
+    bool info_only = false;
+
+    /* ------ Leer argumentos ------ */
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc)
+            output_file = argv[++i];
+        else if (arg == "--info")
+            info_only = true;
+        else if (arg == "-h" || arg == "--help")
+        {
+            print_usage(argv[0]);
+            return 0;
+        }
+        else if (input_file.empty())
+            input_file = arg;
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (input_file.empty())
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    /* ------ Leer el camino ------ */
+
+    ifstream in(input_file.c_str(), ios::binary);
+    if (!in.is_open())
+    {
+        cerr << "Error: Could not open " << input_file << "." << endl;
+        return 1;
+    }
+    vector<State> path;
+    int total_m, total_c, boat_capacity;
+    if (!read_results_binary(in, path, total_m, total_c, boat_capacity))
+    {
+        cerr << "Error: " << input_file << " is not a valid binary results file." << endl;
+        return 1;
+    }
+
+    if (info_only)
+    {
+        cout << "Missionaries: " << total_m << ", Cannibals: " << total_c << ", Boat capacity: " << boat_capacity << ", Moves: "
+             << (path.empty() ? 0 : path.size() - 1) << endl;
+        return 0;
+    }
+
+    /* ------ Escribir el texto ------ */
+
+    if (output_file.empty())
+    {
+        write_results(cout, path, total_m, total_c, boat_capacity);
+    }
+    else
+    {
+        ofstream results_file(output_file.c_str());
+        if (!results_file.is_open())
+        {
+            cerr << "Error: Could not open " << output_file << " to save the results." << endl;
+            return 1;
+        }
+        write_results(results_file, path, total_m, total_c, boat_capacity);
+    }
+
+    return 0;
+}
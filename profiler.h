@@ -0,0 +1,155 @@
+// Instrumentación de la simulación: guarda los tiempos de los últimos frames en un buffer circular para calcular percentiles
+// (p50, p95, p99) y una lista acotada de eventos que se puede exportar en el formato de trazas de Chrome (chrome://tracing o
+// https://ui.perfetto.dev) para revisar después los picos, no depende de allegro, el panel que muestra los datos esta en main
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Librerías estándar de c++
+#include <ostream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+// Hilos con los que se marcan los eventos de la traza, cada uno sale en su propia fila al abrirla
+const int TRACE_MAIN_THREAD = 1;
+const int TRACE_SOLVER_THREAD = 2;
+
+// Datos de un frame dibujado
+struct FrameSample
+{
+    // Momento en que empezó a dibujarse, en microsegundos desde que se creo el profiler
+    double start_us;
+    // Tiempo desde el inicio del frame anterior (lo que se percibe como fluidez de la animación)
+    double interval_ms;
+    // Tiempo que tardo en dibujarse el frame, desde limpiar la pantalla hasta después de al_flip_display
+    double render_ms;
+    // Llamadas de dibujo a allegro en el frame (un lote de bitmaps retenidos cuenta como una)
+    int draw_calls;
+    // Eventos que se procesaron desde el frame anterior, mas de uno por frame significa que la cola se estaba acumulando
+    int events;
+    // Ticks del temporizador que se juntaron en este frame sin dibujarse (frames perdidos)
+    int timer_lag;
+};
+
+// Un evento de la traza, "X" es un bloque con duración y "C" un contador
+struct TraceEvent
+{
+    const char *name;
+    char phase;
+    int tid;
+    double ts_us;
+    double dur_us;
+    // Valor del contador, o para los bloques un dato extra (estados explorados de una resolución, llamadas de dibujo de un frame)
+    long long value;
+};
+
+// Instrumentación de los frames, todas las funciones se llaman desde el hilo principal
+struct FrameProfiler
+{
+    chrono::steady_clock::time_point origin;
+    // Buffer circular con los últimos frames, next_frame es donde va el siguiente y frame_count cuantos son validos
+    vector<FrameSample> frames;
+    size_t next_frame, frame_count;
+    // Buffer circular con los últimos eventos de la traza, al llenarse se pierden los mas viejos
+    vector<TraceEvent> trace;
+    size_t next_trace, trace_count;
+    // Copia de los tiempos para calcular percentiles sin reservar memoria en cada frame
+    vector<double> scratch;
+    // Inicio del frame anterior, para calcular el intervalo entre frames
+    double last_start_us;
+
+    FrameProfiler(size_t max_frames, size_t max_trace_events)
+        : origin(chrono::steady_clock::now()), frames(max_frames), next_frame(0), frame_count(0), trace(max_trace_events),
+          next_trace(0), trace_count(0), last_start_us(-1)
+    {
+        scratch.reserve(max_frames);
+    }
+
+    // Microsegundos desde que se creo el profiler
+    double now_us() const
+    {
+        return to_us(chrono::steady_clock::now());
+    }
+
+    // Convierte un momento del reloj a microsegundos desde que se creo el profiler
+    double to_us(chrono::steady_clock::time_point t) const
+    {
+        return chrono::duration<double, micro>(t - origin).count();
+    }
+
+    // Registra un frame que empezó en start_us y termino en end_us, y lo agrega también a la traza
+    void add_frame(double start_us, double end_us, int draw_calls, int events, int timer_lag)
+    {
+        FrameSample sample;
+        sample.start_us = start_us;
+        sample.interval_ms = last_start_us < 0 ? 0 : (start_us - last_start_us) / 1000.0;
+        sample.render_ms = (end_us - start_us) / 1000.0;
+        sample.draw_calls = draw_calls;
+        sample.events = events;
+        sample.timer_lag = timer_lag;
+        last_start_us = start_us;
+
+        frames[next_frame] = sample;
+        next_frame = (next_frame + 1) % frames.size();
+        frame_count = min(frame_count + 1, frames.size());
+
+        TraceEvent frame = {"frame", 'X', TRACE_MAIN_THREAD, start_us, end_us - start_us, draw_calls};
+        add_trace(frame);
+        TraceEvent queue = {"events per frame", 'C', TRACE_MAIN_THREAD, start_us, 0, events};
+        add_trace(queue);
+        if (timer_lag > 0)
+        {
+            TraceEvent lag = {"dropped timer ticks", 'C', TRACE_MAIN_THREAD, start_us, 0, timer_lag};
+            add_trace(lag);
+        }
+    }
+
+    void add_trace(const TraceEvent &event)
+    {
+        trace[next_trace] = event;
+        next_trace = (next_trace + 1) % trace.size();
+        trace_count = min(trace_count + 1, trace.size());
+    }
+
+    // Ultimo frame registrado, solo es valido si frame_count > 0
+    const FrameSample &last_frame() const
+    {
+        return frames[(next_frame + frames.size() - 1) % frames.size()];
+    }
+
+    // Percentil p (entre 0 y 1) del campo dado de los frames guardados, por ejemplo percentile(&FrameSample::render_ms, 0.95)
+    double percentile(double FrameSample::*field, double p)
+    {
+        if (frame_count == 0)
+            return 0;
+        scratch.clear();
+        for (size_t i = 0; i < frame_count; ++i)
+            scratch.push_back(frames[i].*field);
+        size_t k = min(frame_count - 1, (size_t)(p * frame_count));
+        nth_element(scratch.begin(), scratch.begin() + k, scratch.end());
+        return scratch[k];
+    }
+
+    // Escribe los eventos guardados en el formato JSON de trazas de Chrome, del mas viejo al mas nuevo
+    void write_chrome_trace(ostream &out) const
+    {
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << TRACE_MAIN_THREAD << ", \"args\": {\"name\": \"main loop\"}},\n";
+        out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << TRACE_SOLVER_THREAD << ", \"args\": {\"name\": \"solver\"}}";
+        size_t first = (next_trace + trace.size() - trace_count) % trace.size();
+        for (size_t i = 0; i < trace_count; ++i)
+        {
+            const TraceEvent &e = trace[(first + i) % trace.size()];
+            out << ",\n{\"name\": \"" << e.name << "\", \"ph\": \"" << e.phase << "\", \"pid\": 1, \"tid\": " << e.tid << ", \"ts\": " << (long long)e.ts_us;
+            if (e.phase == 'X')
+                out << ", \"dur\": " << (long long)e.dur_us << ", \"args\": {\"value\": " << e.value << "}}";
+            else
+                out << ", \"args\": {\"" << e.name << "\": " << e.value << "}}";
+        }
+        out << "\n]}\n";
+    }
+};
+
+#endif
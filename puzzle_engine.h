@@ -0,0 +1,421 @@
+// Variantes del problema de cruzar el río para el motor de búsqueda genérico PuzzleSearch de solver.h. Cada variante es una
+// clase de reglas (ver el comentario de PuzzleSearch), el problema clásico también es una de ellas (ClassicRules, en solver.h)
+// y es la que usan BfsSearch, la simulación y mc_cli. Aquí están las demás y las funciones para resolverlas y mostrarlas.
+#ifndef PUZZLE_ENGINE_H
+#define PUZZLE_ENGINE_H
+
+#include "solver.h"
+// Librerías estándar de c++
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+
+using namespace std;
+
+// Resuelve una variante hasta terminar (o hasta que se pida cancelar), devuelve si se encontró solución y en ese caso guarda el
+// camino en path
+template <class Rules>
+bool solve_puzzle(const Rules &rules, vector<typename Rules::StateType> &path, SolveStats *stats = nullptr,
+                  SolveControl *control = nullptr)
+{
+    path.clear();
+    PuzzleSearch<Rules> search(rules);
+    search.restart(rules.initial_state());
+    SearchStatus status = run_search(search, control);
+
+    if (stats)
+    {
+        stats->states_expanded = search.states_expanded;
+        stats->visited_bytes = search_visited_bytes(search);
+        stats->search_bytes = search.memory_bytes();
+    }
+    if (status != SEARCH_FOUND)
+        return false;
+
+    search.build_path(path);
+    return true;
+}
+
+// Escribe el camino de una variante con el mismo encabezado y formato de pasos que results.txt
+template <class Rules>
+void write_puzzle_results(ostream &out, const Rules &rules, const vector<typename Rules::StateType> &path, const char *title)
+{
+    out << "Solution for " << title << "\n";
+    out << "------------------------------------------\n";
+    char line[512];
+    for (size_t i = 0; i < path.size(); ++i)
+    {
+        rules.describe(path[i], line, sizeof(line));
+        out << "Step " << i << ": " << line << "\n";
+    }
+    out.flush();
+}
+
+/* ------ Misioneros y caníbales ------ */
+
+// Las reglas del problema clásico (MissionaryRules y ClassicRules) están en solver.h, junto al motor
+
+/* ------ Un solo caníbal rema ------ */
+
+// Estado de la variante del remero: el State clásico mas la orilla donde esta el caníbal que sabe remar, este caníbal
+// cuenta como uno mas en c_left o en la derecha
+struct RowerState
+{
+    State s;
+    int rower_pos;
+};
+
+// Todos los misioneros saben remar pero de los caníbales solo uno, por lo que el bote nunca puede cruzar solo con caníbales
+// si no va ese caníbal. Cada movimiento es un grupo (misioneros, caníbales) y si el remero va en el, el bote debe ser seguro
+// igual que en las reglas de la simulación
+struct RowerRules
+{
+    typedef RowerState StateType;
+
+    // Un grupo del bote y si el caníbal que rema va en el (cuenta dentro de c)
+    struct RowerLoad
+    {
+        int m, c;
+        bool with_rower;
+    };
+
+    int total_m, total_c;
+    vector<RowerLoad> moves;
+    VisitedTable table;
+
+    RowerRules(int m, int c, int boat_capacity) : total_m(m), total_c(c)
+    {
+        vector<BoatLoad> loads = build_move_table(boat_capacity);
+        for (size_t i = 0; i < loads.size(); ++i)
+        {
+            // Sin misioneros en el bote el remero tiene que ir, con misioneros puede ir o no
+            if (loads[i].c > 0)
+            {
+                RowerLoad load = {loads[i].m, loads[i].c, true};
+                moves.push_back(load);
+            }
+            if (loads[i].m > 0)
+            {
+                RowerLoad load = {loads[i].m, loads[i].c, false};
+                moves.push_back(load);
+            }
+        }
+        table.reset_index(total_m, total_c);
+    }
+
+    RowerState initial_state() const
+    {
+        RowerState r = {State::make(total_m, total_c, 0), 0};
+        return r;
+    }
+
+    bool is_legal(const RowerState &r) const
+    {
+        return is_valid(r.s, total_m, total_c);
+    }
+
+    bool is_goal(const RowerState &r) const
+    {
+        // Si todos están a la derecha el remero también
+        return is_solution(r.s, total_m, total_c);
+    }
+
+    size_t move_count() const
+    {
+        return moves.size();
+    }
+
+    bool apply(const RowerState &r, size_t i, RowerState &next_r) const
+    {
+        const RowerLoad &load = moves[i];
+        int boat = r.s.boat_pos();
+        if (load.with_rower)
+        {
+            // El remero tiene que estar en la orilla del bote
+            if (r.rower_pos != boat)
+                return false;
+            next_r.rower_pos = 1 - boat;
+        }
+        else
+        {
+            // Si el remero se queda en la orilla del bote, los caníbales del grupo tienen que ser otros
+            int c_available = boat == 0 ? r.s.c_left() : r.s.c_right(total_c);
+            if (r.rower_pos == boat && load.c > c_available - 1)
+                return false;
+            next_r.rower_pos = r.rower_pos;
+        }
+        return apply_move(r.s, load.m, load.c, total_m, total_c, next_r.s) && is_valid(next_r.s, total_m, total_c);
+    }
+
+    size_t state_count() const
+    {
+        return table.size() * 2;
+    }
+
+    size_t index(const RowerState &r) const
+    {
+        return table.index(r.s) * 2 + r.rower_pos;
+    }
+
+    size_t memory_bytes() const
+    {
+        return moves.capacity() * sizeof(RowerLoad) + table.memory_bytes();
+    }
+
+    void describe(const RowerState &r, char *line, size_t size) const
+    {
+        StateView v = r.s.view(total_m, total_c);
+        snprintf(line, size, "Left(M:%d, C:%d) Right(M:%d, C:%d) Boat:%s Rower:%s", v.m_left, v.c_left, v.m_right, v.c_right,
+                 v.boat_pos == 0 ? "Left" : "Right", r.rower_pos == 0 ? "Left" : "Right");
+    }
+};
+
+/* ------ Maridos celosos ------ */
+
+// Mayor numero de parejas, con 12 hay 2^25 estados (4 MB de visitados y 64 MB de padres)
+const int MAX_COUPLES = 12;
+
+// Estado de la variante de los maridos celosos: un bit por persona con la orilla donde esta (1 es la derecha), los
+// maridos en los bits 0 a n-1, la esposa de cada uno n bits después, y el bote en el bit 2n
+struct CoupleState
+{
+    uint64_t bits;
+};
+
+// n parejas cruzan el río, ninguna esposa puede estar con otro hombre (en una orilla o en el bote) si su marido no esta
+// presente. Cada movimiento es un subconjunto de hasta boat_capacity personas, guardado como mascara de bits
+struct JealousHusbandsRules
+{
+    typedef CoupleState StateType;
+
+    int couples;
+    uint64_t people_mask, boat_bit;
+    vector<uint64_t> moves;
+
+    JealousHusbandsRules(int n, int boat_capacity) : couples(n)
+    {
+        people_mask = (uint64_t(1) << (2 * couples)) - 1;
+        boat_bit = uint64_t(1) << (2 * couples);
+        // Todos los grupos de 1 a boat_capacity personas que son seguros dentro del bote
+        for (uint64_t group = 1; group <= people_mask; ++group)
+        {
+            int size = 0;
+            for (uint64_t g = group; g; g &= g - 1)
+                size++;
+            if (size <= boat_capacity && is_safe(group))
+                moves.push_back(group);
+        }
+    }
+
+    // Un grupo de personas es seguro si no tiene hombres, o si cada esposa del grupo tiene ahí a su marido
+    bool is_safe(uint64_t group) const
+    {
+        uint64_t husbands = group & ((uint64_t(1) << couples) - 1);
+        uint64_t wives = group >> couples;
+        return husbands == 0 || (wives & ~husbands) == 0;
+    }
+
+    CoupleState initial_state() const
+    {
+        CoupleState s = {0};
+        return s;
+    }
+
+    bool is_legal(const CoupleState &s) const
+    {
+        uint64_t right = s.bits & people_mask;
+        return is_safe(right) && is_safe(~right & people_mask);
+    }
+
+    bool is_goal(const CoupleState &s) const
+    {
+        return s.bits == (people_mask | boat_bit);
+    }
+
+    size_t move_count() const
+    {
+        return moves.size();
+    }
+
+    bool apply(const CoupleState &s, size_t i, CoupleState &next_s) const
+    {
+        uint64_t group = moves[i];
+        // Personas en la orilla donde esta el bote
+        uint64_t on_boat_side = (s.bits & boat_bit) ? (s.bits & people_mask) : (~s.bits & people_mask);
+        if ((group & on_boat_side) != group)
+            return false;
+        next_s.bits = (s.bits ^ group) ^ boat_bit;
+        return is_legal(next_s);
+    }
+
+    size_t state_count() const
+    {
+        return size_t(boat_bit) * 2;
+    }
+
+    size_t index(const CoupleState &s) const
+    {
+        return size_t(s.bits);
+    }
+
+    size_t memory_bytes() const
+    {
+        return moves.capacity() * sizeof(uint64_t);
+    }
+
+    // Las parejas se escriben como H1 W1 H2 W2... en la orilla donde están
+    void describe(const CoupleState &s, char *line, size_t size) const
+    {
+        string banks[2];
+        for (int p = 0; p < 2 * couples; ++p)
+        {
+            string &bank = banks[(s.bits >> p) & 1];
+            if (!bank.empty())
+                bank += ' ';
+            bank += (p < couples ? "H" : "W") + to_string(p % couples + 1);
+        }
+        snprintf(line, size, "Left(%s) Right(%s) Boat:%s", banks[0].c_str(), banks[1].c_str(), s.bits & boat_bit ? "Right" : "Left");
+    }
+};
+
+/* ------ Dos botes ------ */
+
+// Estado de la variante de 2 botes: el State clásico, donde el bit del bote es la orilla del primer bote, mas la orilla del
+// segundo bote
+struct TwoBoatState
+{
+    State s;
+    int second_boat;
+};
+
+// Hay 2 botes, cada uno con su capacidad, y en cada viaje cruza uno solo de ellos (el que este en la orilla del grupo). Dentro
+// de cada bote se aplican las mismas reglas que en la simulación. Como ya no hay un solo bote que tenga que terminar a la
+// derecha, basta con que todos hayan cruzado
+struct TwoBoatRules
+{
+    typedef TwoBoatState StateType;
+
+    // Un grupo y el bote en el que viaja (0 el primero, 1 el segundo)
+    struct TwoBoatLoad
+    {
+        int m, c;
+        int boat;
+    };
+
+    int total_m, total_c;
+    vector<TwoBoatLoad> moves;
+    VisitedTable table;
+
+    TwoBoatRules(int m, int c, int first_capacity, int second_capacity) : total_m(m), total_c(c)
+    {
+        int capacities[2] = {first_capacity, second_capacity};
+        for (int boat = 0; boat < 2; ++boat)
+        {
+            vector<BoatLoad> loads = build_move_table(capacities[boat]);
+            for (size_t i = 0; i < loads.size(); ++i)
+            {
+                TwoBoatLoad load = {loads[i].m, loads[i].c, boat};
+                moves.push_back(load);
+            }
+        }
+        table.reset_index(total_m, total_c);
+    }
+
+    TwoBoatState initial_state() const
+    {
+        TwoBoatState t = {State::make(total_m, total_c, 0), 0};
+        return t;
+    }
+
+    bool is_legal(const TwoBoatState &t) const
+    {
+        return is_valid(t.s, total_m, total_c);
+    }
+
+    bool is_goal(const TwoBoatState &t) const
+    {
+        return t.s.m_left() == 0 && t.s.c_left() == 0;
+    }
+
+    size_t move_count() const
+    {
+        return moves.size();
+    }
+
+    bool apply(const TwoBoatState &t, size_t i, TwoBoatState &next_t) const
+    {
+        const TwoBoatLoad &load = moves[i];
+        if (load.boat == 0)
+        {
+            next_t.second_boat = t.second_boat;
+            return apply_move(t.s, load.m, load.c, total_m, total_c, next_t.s) && is_valid(next_t.s, total_m, total_c);
+        }
+
+        // Para mover el segundo bote lo ponemos en el bit del bote, aplicamos el movimiento y regresamos el primer bote a su orilla
+        uint64_t boat_bit = uint64_t(1) << State::BOAT_SHIFT;
+        State second = t.s;
+        second.bits = (t.s.bits & ~boat_bit) | (uint64_t(t.second_boat) << State::BOAT_SHIFT);
+        State moved;
+        if (!apply_move(second, load.m, load.c, total_m, total_c, moved))
+            return false;
+        next_t.second_boat = moved.boat_pos();
+        next_t.s.bits = (moved.bits & ~boat_bit) | (t.s.bits & boat_bit);
+        return is_valid(next_t.s, total_m, total_c);
+    }
+
+    size_t state_count() const
+    {
+        return table.size() * 2;
+    }
+
+    size_t index(const TwoBoatState &t) const
+    {
+        return table.index(t.s) * 2 + t.second_boat;
+    }
+
+    size_t memory_bytes() const
+    {
+        return moves.capacity() * sizeof(TwoBoatLoad) + table.memory_bytes();
+    }
+
+    void describe(const TwoBoatState &t, char *line, size_t size) const
+    {
+        StateView v = t.s.view(total_m, total_c);
+        snprintf(line, size, "Left(M:%d, C:%d) Right(M:%d, C:%d) Boat:%s Boat2:%s", v.m_left, v.c_left, v.m_right, v.c_right,
+                 v.boat_pos == 0 ? "Left" : "Right", t.second_boat == 0 ? "Left" : "Right");
+    }
+};
+
+/* ------ Selección de la variante ------ */
+
+// Variantes que se pueden resolver con el motor genérico
+enum PuzzleVariant
+{
+    VARIANT_CLASSIC,         // Las reglas de la simulación (el bote también debe ser seguro)
+    VARIANT_BANKS_ONLY,      // Solo se revisan las orillas, no el bote
+    VARIANT_ROWER,           // Solo los misioneros y un caníbal saben remar
+    VARIANT_JEALOUS_HUSBANDS, // Parejas, misioneros = maridos y caníbales = esposas
+    VARIANT_TWO_BOATS         // Un segundo bote con su propia capacidad
+};
+
+// Convierte el nombre de una variante a su valor, devuelve false si no se reconoce
+inline bool parse_variant(const string &name, PuzzleVariant &variant)
+{
+    if (name == "classic" || name == "boat-safe")
+        variant = VARIANT_CLASSIC;
+    else if (name == "banks-only")
+        variant = VARIANT_BANKS_ONLY;
+    else if (name == "rower")
+        variant = VARIANT_ROWER;
+    else if (name == "husbands" || name == "jealous-husbands")
+        variant = VARIANT_JEALOUS_HUSBANDS;
+    else if (name == "two-boats" || name == "multi-boat")
+        variant = VARIANT_TWO_BOATS;
+    else
+        return false;
+    return true;
+}
+
+#endif
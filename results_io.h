@@ -0,0 +1,212 @@
+// Escritura y lectura de los resultados (el camino de la solución), en dos formatos:
+// - Texto: el formato de siempre de results.txt, un paso por linea, pensado para leerse
+// - Binario: un encabezado con el problema y el estado inicial, y después solo el grupo que viajo en el bote en cada paso
+//   como 2 enteros de tamaño variable (normalmente 1 byte cada uno), ya que la dirección del bote siempre se alterna, con
+//   esto un camino ocupa unos 2 bytes por paso en lugar de ~60 del texto
+// Ambos escriben con un buffer propio y hacen flush una sola vez al final, en lugar de hacerlo en cada linea con endl
+#ifndef RESULTS_IO_H
+#define RESULTS_IO_H
+
+#include "solver.h"
+// Librerías estándar de c++
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+// Formatos en los que se pueden guardar los resultados
+enum ResultsFormat
+{
+    RESULTS_TEXT,  // Texto legible, el formato de results.txt
+    RESULTS_BINARY // Binario compacto, se convierte a texto con mc_path
+};
+
+// Encabezado del formato binario, el numero al final es la versión del formato
+const char RESULTS_BINARY_MAGIC[8] = {'M', 'C', 'P', 'A', 'T', 'H', '0', '1'};
+
+// Nombre del archivo de resultados que usa la simulación para cada formato
+inline const char *results_file_name(ResultsFormat format)
+{
+    return format == RESULTS_BINARY ? "results.bin" : "results.txt";
+}
+
+// Convierte el nombre de un formato ("text" o "binary") a su valor, devuelve false si no se reconoce
+inline bool parse_results_format(const string &name, ResultsFormat &format)
+{
+    if (name == "text" || name == "txt")
+        format = RESULTS_TEXT;
+    else if (name == "binary" || name == "bin")
+        format = RESULTS_BINARY;
+    else
+        return false;
+    return true;
+}
+
+// Buffer de salida, junta lo que se escribe y lo manda al stream en bloques grandes
+struct OutputBuffer
+{
+    ostream &out;
+    vector<char> data;
+    size_t used;
+
+    OutputBuffer(ostream &out_, size_t capacity = 1 << 16) : out(out_), data(capacity), used(0) {}
+
+    void write(const char *bytes, size_t count)
+    {
+        if (used + count > data.size())
+            flush_to_stream();
+        if (count > data.size())
+        {
+            out.write(bytes, count);
+            return;
+        }
+        memcpy(&data[used], bytes, count);
+        used += count;
+    }
+
+    void put(char byte)
+    {
+        if (used == data.size())
+            flush_to_stream();
+        data[used++] = byte;
+    }
+
+    // Escribe un entero sin signo con 7 bits por byte, el bit alto indica si sigue otro byte (LEB128)
+    void put_varint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            put(char((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        put(char(value));
+    }
+
+    // Manda lo que hay en el buffer al stream (sin hacer flush del stream)
+    void flush_to_stream()
+    {
+        if (used > 0)
+            out.write(&data[0], used);
+        used = 0;
+    }
+};
+
+// Escribe la solución en el formato de results.txt: primero la información del problema que se resolvió y después cada
+// paso del camino, se usa tanto para el archivo que genera la simulación como para la salida de la linea de comandos
+inline void write_results(ostream &out, const vector<State> &path, int total_m, int total_c, int boat_capacity)
+{
+    OutputBuffer buffer(out);
+    char line[160];
+    int length;
+
+    // Imprimimos arriba la información sobre el problema que se resolvió
+    length = snprintf(line, sizeof(line), "Solution for Missionaries: %d, Cannibals: %d\nBoat capacity: %d\n", total_m, total_c, boat_capacity);
+    buffer.write(line, length);
+    buffer.write("------------------------------------------\n", 43);
+    // Recorremos nuestro vector
+    for (size_t i = 0; i < path.size(); ++i)
+    {
+        // Guardamos una instancia temporal para el estado del vector
+        StateView s = path[i].view(total_m, total_c);
+        // Imprimimos la información de este estado
+        length = snprintf(line, sizeof(line), "Step %llu: Left(M:%d, C:%d) Right(M:%d, C:%d) Boat:%s\n", (unsigned long long)i, s.m_left,
+                          s.c_left, s.m_right, s.c_right, s.boat_pos == 0 ? "Left" : "Right");
+        buffer.write(line, length);
+    }
+    buffer.flush_to_stream();
+    out.flush();
+}
+
+// Escribe la solución en el formato binario: el encabezado, los totales y la capacidad (uint32), el numero de estados
+// (uint64), el estado inicial (uint64) y por cada paso los misioneros y caníbales que viajaron en el bote
+inline void write_results_binary(ostream &out, const vector<State> &path, int total_m, int total_c, int boat_capacity)
+{
+    OutputBuffer buffer(out);
+    buffer.write(RESULTS_BINARY_MAGIC, sizeof(RESULTS_BINARY_MAGIC));
+    uint32_t header[3] = {(uint32_t)total_m, (uint32_t)total_c, (uint32_t)boat_capacity};
+    buffer.write((const char *)header, sizeof(header));
+    uint64_t count = path.size();
+    buffer.write((const char *)&count, sizeof(count));
+    if (!path.empty())
+    {
+        buffer.write((const char *)&path[0].bits, sizeof(path[0].bits));
+        // El grupo que viajo es la diferencia de la orilla izquierda entre un paso y el siguiente (en cualquier dirección)
+        for (size_t i = 1; i < path.size(); ++i)
+        {
+            buffer.put_varint((uint64_t)abs(path[i].m_left() - path[i - 1].m_left()));
+            buffer.put_varint((uint64_t)abs(path[i].c_left() - path[i - 1].c_left()));
+        }
+    }
+    buffer.flush_to_stream();
+    out.flush();
+}
+
+// Escribe la solución en el formato elegido
+inline void write_results_as(ResultsFormat format, ostream &out, const vector<State> &path, int total_m, int total_c, int boat_capacity)
+{
+    if (format == RESULTS_BINARY)
+        write_results_binary(out, path, total_m, total_c, boat_capacity);
+    else
+        write_results(out, path, total_m, total_c, boat_capacity);
+}
+
+// Lee un entero escrito con put_varint, devuelve false si el archivo se termina antes
+inline bool read_varint(istream &in, uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int byte = in.get();
+        if (byte == EOF)
+            return false;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// Lee un archivo escrito por write_results_binary, reconstruyendo cada estado a partir del anterior con el grupo que viajo
+// en el bote, devuelve false si el archivo no tiene el formato o si algún paso no es un movimiento valido
+inline bool read_results_binary(istream &in, vector<State> &path, int &total_m, int &total_c, int &boat_capacity)
+{
+    char magic[sizeof(RESULTS_BINARY_MAGIC)];
+    uint32_t header[3];
+    uint64_t count;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, RESULTS_BINARY_MAGIC, sizeof(magic)) != 0 ||
+        !in.read((char *)header, sizeof(header)) || !in.read((char *)&count, sizeof(count)))
+        return false;
+    if (header[0] > State::COUNT_MASK || header[1] > State::COUNT_MASK || header[2] < 1 || header[2] > (uint32_t)MAX_BOAT_CAPACITY)
+        return false;
+    total_m = (int)header[0];
+    total_c = (int)header[1];
+    boat_capacity = (int)header[2];
+
+    path.clear();
+    if (count == 0)
+        return true;
+
+    State s;
+    if (!in.read((char *)&s.bits, sizeof(s.bits)) || s.boat_pos() > 1 || !is_valid(s, total_m, total_c))
+        return false;
+    path.push_back(s);
+
+    for (uint64_t i = 1; i < count; ++i)
+    {
+        uint64_t m_boat, c_boat;
+        if (!read_varint(in, m_boat) || !read_varint(in, c_boat) || m_boat + c_boat < 1 || m_boat + c_boat > (uint64_t)boat_capacity)
+            return false;
+        State next_s;
+        if (!apply_move(s, (int)m_boat, (int)c_boat, total_m, total_c, next_s) || !is_valid(next_s, total_m, total_c))
+            return false;
+        path.push_back(next_s);
+        s = next_s;
+    }
+    return true;
+}
+
+#endif
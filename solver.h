@@ -0,0 +1,1308 @@
+// Solucionador del problema de misioneros y caníbales, no depende de allegro para poder usarse tanto desde la simulación
+// (main.cpp) como desde la linea de comandos (cli.cpp), todo vive en este encabezado por lo que basta con incluirlo
+#ifndef SOLVER_H
+#define SOLVER_H
+
+// Librerías estándar de c++
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cctype>
+#include <cstdlib>
+#include <cstdio>
+#include <atomic>
+
+using namespace std;
+
+// Vista "desempaquetada" de un estado del problema con los 5 campos por separado, ocupa 20 bytes por lo que no se usa para
+// guardar estados (para eso esta State), solo para leerlos con comodidad al dibujar o al escribir resultados
+struct StateView
+{
+    // Misioneros y caníbales en izquierda
+    int m_left, c_left;
+    // Misioneros y caníbales en la derecha
+    int m_right, c_right;
+    // Declaramos la posición del bote con 0 para la izquierda y 1 para la derecha
+    int boat_pos;
+};
+
+// Estructura para representar el estado del problema, empaquetada en una sola palabra de 64 bits:
+// - bits 0 a 30: misioneros en la izquierda
+// - bits 31 a 61: caníbales en la izquierda
+// - bit 62: posición del bote (0 izquierda, 1 derecha)
+// Los misioneros y caníbales de la derecha no se guardan, ya que siempre son el total menos los de la izquierda, por eso
+// sus accesores piden el total. Asi un estado ocupa 8 bytes en lugar de 20, lo que importa cuando los caminos y las colas
+// de búsqueda tienen millones de estados
+struct State
+{
+    uint64_t bits;
+
+    // Numero de bits para cada contador y posición de cada campo dentro de la palabra
+    static const int COUNT_BITS = 31;
+    static const uint64_t COUNT_MASK = (uint64_t(1) << COUNT_BITS) - 1;
+    static const int C_SHIFT = COUNT_BITS;
+    static const int BOAT_SHIFT = 2 * COUNT_BITS;
+
+    // Construye un estado a partir de los valores de la orilla izquierda y la posición del bote
+    static State make(int m_left, int c_left, int boat_pos)
+    {
+        State s;
+        s.bits = uint64_t(m_left) | (uint64_t(c_left) << C_SHIFT) | (uint64_t(boat_pos) << BOAT_SHIFT);
+        return s;
+    }
+
+    int m_left() const { return int(bits & COUNT_MASK); }
+    int c_left() const { return int((bits >> C_SHIFT) & COUNT_MASK); }
+    int boat_pos() const { return int(bits >> BOAT_SHIFT); }
+    int m_right(int total_m) const { return total_m - m_left(); }
+    int c_right(int total_c) const { return total_c - c_left(); }
+
+    // Desempaqueta el estado en sus 5 campos
+    StateView view(int total_m, int total_c) const
+    {
+        StateView v = {m_left(), c_left(), m_right(total_m), c_right(total_c), boat_pos()};
+        return v;
+    }
+
+    // Al estar todo el estado en una sola palabra, comparar 2 estados es comparar 2 enteros
+    bool operator==(const State &state2) const
+    {
+        return bits == state2.bits;
+    }
+
+    bool operator!=(const State &state2) const
+    {
+        return bits != state2.bits;
+    }
+
+    // Orden para poder usar el estado en contenedores ordenados como set o map
+    bool operator<(const State &state2) const
+    {
+        return bits < state2.bits;
+    }
+};
+
+// Convierte un argumento a entero, devuelve false si no es un numero entero no negativo o si no cabe en los contadores de
+// State, es el mismo limite para todos los programas y para las listas del modo por lotes
+inline bool parse_count(const char *text, int &value)
+{
+    char *end = nullptr;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < 0 || parsed > (long)State::COUNT_MASK)
+        return false;
+    value = (int)parsed;
+    return true;
+}
+
+// La capacidad del bote por defecto para el problema es de 2, se puede cambiar en el menu o desde la linea de comandos
+const int DEFAULT_BOAT_CAPACITY = 2;
+// Capacidad máxima que aceptamos, con ella la tabla de movimientos tiene menos de 65535 entradas, lo que permite guardar el
+// movimiento de cada estado en 2 bytes (ver BfsSearch)
+const int MAX_BOAT_CAPACITY = 100;
+
+// Esta es la verificación mas importante, ya que a medida que vamos resolviendo el problema se utilizara para ver si
+// vamos por buen camino o si se ha cometido algún error
+inline bool is_valid(const State &s, int total_m, int total_c)
+{
+    int m_left = s.m_left(), c_left = s.c_left();
+    int m_right = s.m_right(total_m), c_right = s.c_right(total_c);
+
+    // Comprueba números negativos (en la izquierda no puede haber mas personas que el total)
+    if (m_right < 0 || c_right < 0)
+        return false;
+
+    // Comprueba si los misioneros son superados en número en la orilla izquierda
+    if (m_left > 0 && m_left < c_left)
+        return false;
+    // Comprueba si los misioneros son superados en número en la orilla derecha
+    if (m_right > 0 && m_right < c_right)
+        return false;
+
+    // Si ninguna de estas condiciones es verdadera, significa que el estado actual
+    // del problema es valido
+    return true;
+}
+
+// Función simple para comprobar si se ha resuelto el problema
+inline bool is_solution(const State &s, int /*total_m*/, int /*total_c*/)
+{
+    // Donde los misioneros, caníbales y el bote estén a la derecha, como la derecha se calcula a partir del total, basta
+    // con que la izquierda este vacía
+    return s.m_left() == 0 && s.c_left() == 0 && s.boat_pos() == 1;
+}
+
+// Aplica un movimiento del bote con m_boat misioneros y c_boat caníbales sobre el estado current_s, guardando el resultado en next_s,
+// devuelve false si en la orilla donde está el bote no hay suficientes personas para hacer este movimiento
+inline bool apply_move(const State &current_s, int m_boat, int c_boat, int total_m, int total_c, State &next_s)
+{
+    // Grupo que va en el bote ya acomodado en los mismos bits que usa State, asi mover el grupo de una orilla a la otra es
+    // una sola suma o resta sobre la palabra, y cambiar el bote de orilla es invertir su bit
+    uint64_t load = uint64_t(m_boat) | (uint64_t(c_boat) << State::C_SHIFT);
+    uint64_t boat_bit = uint64_t(1) << State::BOAT_SHIFT;
+
+    // Si el bote se encuentra del lado izquierdo
+    if (current_s.boat_pos() == 0)
+    {
+        // Verificamos si el numero de misioneros y caníbales que vamos a mover están disponibles del lado izquierdo
+        if (current_s.m_left() < m_boat || current_s.c_left() < c_boat)
+            return false;
+        // Quitamos el grupo de la izquierda (lo que lo deja en la derecha) y pasamos el bote a la derecha
+        next_s.bits = (current_s.bits - load) ^ boat_bit;
+    }
+    // Si el bote se encuentra del lado derecho
+    else
+    {
+        // Realizamos la misma verificación para ver si del lado derecho hay suficientes misioneros y caníbales
+        if (current_s.m_right(total_m) < m_boat || current_s.c_right(total_c) < c_boat)
+            return false;
+        // Agregamos el grupo a la izquierda y pasamos el bote a la izquierda
+        next_s.bits = (current_s.bits + load) ^ boat_bit;
+    }
+
+    return true;
+}
+
+// Un grupo de personas que puede viajar en el bote
+struct BoatLoad
+{
+    int m, c;
+};
+
+// Construye la lista de todos los grupos que pueden viajar en el bote, esto se hace una sola vez por cada resolución en lugar de
+// recalcularlo con 2 for anidados en cada estado que se expande. Con boat_safe en false también quedan los grupos con mas
+// caníbales que misioneros (la variante donde solo se revisan las orillas, ver puzzle_engine.h)
+inline vector<BoatLoad> build_move_table(int boat_capacity, bool boat_safe = true)
+{
+    vector<BoatLoad> moves;
+
+    // Iteramos sobre el numero de misioneros que podrían ir en el bote (de 0 a boat_capacity)
+    for (int m_boat = 0; m_boat <= boat_capacity; ++m_boat)
+    {
+        // Y sobre el numero de caníbales, cuidando no pasarnos de la capacidad del bote
+        for (int c_boat = 0; c_boat <= boat_capacity - m_boat; ++c_boat)
+        {
+            // El bote no puede viajar vació
+            if (m_boat + c_boat == 0)
+                continue;
+            // Dentro del bote tampoco pueden los caníbales superar en numero a los misioneros, estos grupos nunca son validos
+            // sin importar el estado, por lo que los quitamos aquí y no se vuelven a probar en cada expansión
+            if (boat_safe && m_boat > 0 && m_boat < c_boat)
+                continue;
+
+            BoatLoad load = {m_boat, c_boat};
+            moves.push_back(load);
+        }
+    }
+
+    return moves;
+}
+
+// Revisa que path sea una solución completa del problema: que empiece con todos a la izquierda, que cada paso sea cruzar con
+// un grupo de la tabla de movimientos y deje un estado valido, y que termine en la solución. Sirve para los caminos que se
+// leen de un archivo, que pueden venir incompletos o modificados
+inline bool is_solution_path(const vector<State> &path, int total_m, int total_c, int boat_capacity)
+{
+    if (path.empty() || path[0].bits != State::make(total_m, total_c, 0).bits)
+        return false;
+
+    // Grupos permitidos por (misioneros, caníbales) en el bote
+    vector<char> allowed((boat_capacity + 1) * (boat_capacity + 1), 0);
+    vector<BoatLoad> moves = build_move_table(boat_capacity);
+    for (size_t i = 0; i < moves.size(); ++i)
+        allowed[moves[i].m * (boat_capacity + 1) + moves[i].c] = 1;
+
+    for (size_t i = 1; i < path.size(); ++i)
+    {
+        // El grupo que cruzo es la diferencia de la orilla izquierda entre los 2 estados
+        const State &s = path[i - 1];
+        int sign = s.boat_pos() == 0 ? 1 : -1;
+        int m_boat = sign * (s.m_left() - path[i].m_left());
+        int c_boat = sign * (s.c_left() - path[i].c_left());
+        if (m_boat < 0 || c_boat < 0 || m_boat > boat_capacity || c_boat > boat_capacity ||
+            !allowed[m_boat * (boat_capacity + 1) + c_boat])
+            return false;
+
+        // Aplicar el grupo debe dar exactamente el siguiente estado (esto también revisa el bit del bote)
+        State next_s;
+        if (!apply_move(s, m_boat, c_boat, total_m, total_c, next_s) || next_s.bits != path[i].bits ||
+            !is_valid(next_s, total_m, total_c))
+            return false;
+    }
+    return is_solution(path.back(), total_m, total_c);
+}
+
+// Tabla de estados visitados guardada como un bitset plano, en lugar de un set<State> (un árbol con una asignación de
+// memoria por cada estado) usamos un bit por estado, calculando su posición directamente a partir de (m_left, c_left, boat_pos),
+// m_right y c_right no hacen falta ya que siempre son el total menos lo que hay en la izquierda.
+//
+// Ademas, no guardamos todas las combinaciones (M+1)*(C+1)*2, solo las que is_valid puede aceptar: si en la izquierda hay
+// entre 1 y M-1 misioneros, entonces en ambas orillas debe haber al menos tantos misioneros como caníbales, lo que limita
+// c_left a una franja por cada valor de m_left, por ejemplo con M = C solo queda la diagonal, asi la memoria crece con el
+// numero de estados alcanzables y no con M*C
+struct VisitedTable
+{
+    int total_m, total_c;
+    // Posición en la tabla del primer estado de cada fila (una fila por cada valor de m_left)
+    vector<size_t> row_offset;
+    // Un bit por estado
+    vector<uint64_t> bits;
+
+    // Prepara la tabla para un problema con m misioneros y c caníbales, la memoria se reserva una sola vez aquí y si la
+    // tabla se vuelve a usar para otro problema se reutiliza la que ya se tenia
+    void reset(int m, int c)
+    {
+        reset_index(m, c);
+        bits.assign((size() + 63) / 64, 0);
+    }
+
+    // Solo calcula las filas, para usar la tabla para obtener la posición de cada estado sin guardar los bits
+    void reset_index(int m, int c)
+    {
+        total_m = m;
+        total_c = c;
+        row_offset.resize(total_m + 2);
+        row_offset[0] = 0;
+        for (int m_left = 0; m_left <= total_m; ++m_left)
+        {
+            int width = row_last_c(m_left) - row_first_c(m_left) + 1;
+            row_offset[m_left + 1] = row_offset[m_left] + max(0, width);
+        }
+    }
+
+    // Menor numero de caníbales en la izquierda que puede tener un estado valido con m_left misioneros en la izquierda
+    int row_first_c(int m_left) const
+    {
+        // Con todos los misioneros en una orilla no importa cuantos caníbales haya en cada lado
+        if (m_left == 0 || m_left == total_m)
+            return 0;
+        // En la derecha deben quedar a lo mucho tantos caníbales como misioneros
+        return max(0, total_c - (total_m - m_left));
+    }
+
+    // Mayor numero de caníbales en la izquierda para un estado valido con m_left misioneros en la izquierda
+    int row_last_c(int m_left) const
+    {
+        if (m_left == 0 || m_left == total_m)
+            return total_c;
+        // En la izquierda no puede haber mas caníbales que misioneros
+        return min(total_c, m_left);
+    }
+
+    // Numero total de estados que caben en la tabla (cada par (m_left, c_left) con el bote en ambos lados)
+    size_t size() const
+    {
+        return row_offset[total_m + 1] * 2;
+    }
+
+    // Posición de un estado en la tabla, el estado debe de haber pasado is_valid
+    size_t index(const State &s) const
+    {
+        int m_left = s.m_left();
+        return (row_offset[m_left] + (s.c_left() - row_first_c(m_left))) * 2 + s.boat_pos();
+    }
+
+    // Estado que esta en la posición i de la tabla, lo contrario de index(), busca la fila con una búsqueda binaria
+    State state_at(size_t i) const
+    {
+        size_t cell = i / 2;
+        int m_left = int(upper_bound(row_offset.begin(), row_offset.end(), cell) - row_offset.begin()) - 1;
+        return State::make(m_left, row_first_c(m_left) + int(cell - row_offset[m_left]), int(i % 2));
+    }
+
+    bool test(size_t i) const
+    {
+        return (bits[i >> 6] >> (i & 63)) & 1;
+    }
+
+    void set(size_t i)
+    {
+        bits[i >> 6] |= uint64_t(1) << (i & 63);
+    }
+
+    // Marca el estado como visitado y devuelve si ya lo estaba antes
+    bool test_and_set(size_t i)
+    {
+        uint64_t mask = uint64_t(1) << (i & 63);
+        bool was_set = (bits[i >> 6] & mask) != 0;
+        bits[i >> 6] |= mask;
+        return was_set;
+    }
+
+    // Memoria que ocupa la tabla en bytes
+    size_t memory_bytes() const
+    {
+        return bits.capacity() * sizeof(uint64_t) + row_offset.capacity() * sizeof(size_t);
+    }
+};
+
+// Resultado de avanzar una búsqueda que se puede pausar y reanudar
+enum SearchStatus
+{
+    SEARCH_RUNNING,  // Aún quedan estados por explorar
+    SEARCH_FOUND,    // Se encontró la solución
+    SEARCH_EXHAUSTED // Se exploraron todos los estados alcanzables sin encontrar solución
+};
+
+// Un marco (frame) de la pila explícita del DFS, equivale a una llamada de la antigua función recursiva, donde además del
+// estado guardamos en que punto de la tabla de movimientos nos quedamos para poder continuar desde ahí
+struct DfsFrame
+{
+    State state;
+    // Indice del siguiente grupo de la tabla de movimientos que falta por probar desde este estado
+    int next_move;
+};
+
+// Motor de búsqueda DFS iterativo, la pila vive en el heap (dentro del vector) en lugar de la pila del hilo, por lo que su
+// profundidad solo esta limitada por la memoria y no por el tamaño del stack, ademas al guardar la posición de los ciclos en
+// cada marco, la búsqueda se puede pausar con step() y continuar después justo donde se quedo
+struct DfsSearch
+{
+    int total_m, total_c;
+    // Grupos que pueden viajar en el bote, en el mismo orden que los 2 for anidados de la versión recursiva
+    vector<BoatLoad> moves;
+    // Pila de marcos, los estados que contiene (de abajo hacia arriba) son exactamente el camino actual
+    vector<DfsFrame> stack;
+    // Estados ya visitados
+    VisitedTable visited;
+    // Numero de estados que se han agregado al camino durante la búsqueda
+    long long states_expanded;
+    // Estado de la búsqueda tras la ultima llamada a step()
+    SearchStatus status;
+
+    // Prepara la búsqueda a partir del estado inicial
+    void start(const State &initial_s, int m, int c, int boat_capacity)
+    {
+        total_m = m;
+        total_c = c;
+        moves = build_move_table(boat_capacity);
+        stack.clear();
+        visited.reset(total_m, total_c);
+        states_expanded = 0;
+        status = SEARCH_RUNNING;
+        push(initial_s);
+    }
+
+    // Agrega un estado al camino, esto es lo que antes hacia la llamada recursiva al entrar
+    void push(const State &s)
+    {
+        DfsFrame frame = {s, 0};
+        stack.push_back(frame);
+        visited.set(visited.index(s));
+        states_expanded++;
+
+        // Verificamos si el estado que acabamos de agregar es la solución al problema (caso base)
+        if (is_solution(s, total_m, total_c))
+            status = SEARCH_FOUND;
+    }
+
+    // Avanza la búsqueda explorando como máximo max_expansions estados nuevos y devuelve como quedo la búsqueda
+    SearchStatus step(long long max_expansions)
+    {
+        long long expanded = 0;
+
+        while (status == SEARCH_RUNNING && expanded < max_expansions)
+        {
+            // Si ya no quedan marcos, entonces no hay mas estados por explorar y el problema no tiene solución
+            if (stack.empty())
+            {
+                status = SEARCH_EXHAUSTED;
+                break;
+            }
+
+            // Trabajamos siempre con el marco de hasta arriba (el ultimo estado del camino)
+            DfsFrame &frame = stack.back();
+            bool pushed = false;
+
+            // Continuamos recorriendo la tabla de movimientos desde donde se quedo este marco
+            int num_moves = (int)moves.size();
+            for (; frame.next_move < num_moves; ++frame.next_move)
+            {
+                const BoatLoad &load = moves[frame.next_move];
+
+                // Intentamos hacer el movimiento, si no hay suficientes personas en la orilla lo ignoramos
+                State next_s;
+                if (!apply_move(frame.state, load.m, load.c, total_m, total_c, next_s))
+                    continue;
+
+                // Verificamos si el estado es valido y si aun no ha sido visitado
+                if (is_valid(next_s, total_m, total_c) && !visited.test(visited.index(next_s)))
+                {
+                    // Guardamos que el siguiente movimiento a probar desde este marco es el que sigue a este, dado que
+                    // push() puede hacer crecer el vector, ya no usamos frame después de esto
+                    ++frame.next_move;
+                    pushed = true;
+                    push(next_s);
+                    expanded++;
+                    break;
+                }
+            }
+
+            // Si se probaron todas las combinaciones sin encontrar un estado nuevo, quitamos este estado del camino
+            if (!pushed)
+                stack.pop_back();
+        }
+
+        return status;
+    }
+
+    // Copia al vector path el camino encontrado (los estados de la pila de abajo hacia arriba)
+    void build_path(vector<State> &path) const
+    {
+        for (size_t i = 0; i < stack.size(); ++i)
+            path.push_back(stack[i].state);
+    }
+
+    // Memoria reservada por la búsqueda en bytes, como los vectores nunca se encogen es el máximo que llego a ocupar
+    size_t memory_bytes() const
+    {
+        return visited.memory_bytes() + stack.capacity() * sizeof(DfsFrame) + moves.capacity() * sizeof(BoatLoad);
+    }
+};
+
+// Tabla de visitados plana, un bit por cada posición que calcula una clase de reglas (ver PuzzleSearch)
+struct FlatBitset
+{
+    vector<uint64_t> bits;
+
+    void reset(size_t size)
+    {
+        bits.assign((size + 63) / 64, 0);
+    }
+
+    // Marca la posición y devuelve si ya estaba marcada
+    bool test_and_set(size_t i)
+    {
+        uint64_t mask = uint64_t(1) << (i & 63);
+        bool was_set = (bits[i >> 6] & mask) != 0;
+        bits[i >> 6] |= mask;
+        return was_set;
+    }
+
+    size_t memory_bytes() const
+    {
+        return bits.capacity() * sizeof(uint64_t);
+    }
+};
+
+// Mayor numero de movimientos de unas reglas, el movimiento con el que se llega a cada estado se guarda en 2 bytes
+const size_t MAX_PUZZLE_MOVES = 65535;
+
+// Motor de búsqueda BFS (búsqueda en anchura) genérico, a diferencia del DFS este explora los estados por niveles, por lo que el
+// primer camino que encuentra hacia la solución es el que tiene el menor numero de movimientos, igual que DfsSearch se puede
+// pausar y continuar con step(). Las reglas del problema (como se guarda un estado, que movimientos hay, cuando un estado es
+// valido y cuando es la solución) van en una clase que se le pasa como parámetro de plantilla, asi el compilador genera un
+// ciclo especializado para cada conjunto de reglas, con las reglas en linea y sin llamadas virtuales. Las reglas del problema
+// clásico son ClassicRules (BfsSearch), las de las variantes están en puzzle_engine.h. Una clase de reglas debe tener:
+// - StateType: el tipo del estado
+// - initial_state(), is_legal(s) (si en el estado nadie corre peligro, solo se usa para revisar el estado inicial) e is_goal(s)
+// - move_count() y apply(s, i, next): aplica el movimiento i de su tabla sobre s, devuelve false si no se puede hacer o si
+//   deja un estado invalido. Cruzar con el mismo grupo de vuelta debe regresar al estado anterior, asi para reconstruir el
+//   camino basta con guardar el movimiento con el que se llego a cada estado
+// - state_count() e index(s): el tamaño de la tabla de visitados y la posición de cada estado en ella
+// - memory_bytes() y describe(s, line, size), que escribe el estado como texto para mostrar el camino
+template <class Rules>
+struct PuzzleSearch
+{
+    typedef typename Rules::StateType StateType;
+
+    // Reglas del problema que se esta resolviendo, se guardan en la búsqueda para que al reutilizarla se reutilice también
+    // su memoria
+    Rules rules;
+    // Cola de estados por expandir, en lugar de sacar elementos del frente solo avanzamos el indice head
+    vector<StateType> frontier;
+    size_t head;
+    // Estados ya descubiertos
+    FlatBitset visited;
+    // Tabla de padres, para cada estado descubierto guardamos con que movimiento llegamos a el (su indice en la tabla de
+    // movimientos mas 1), dado que hacer el mismo movimiento de vuelta regresa al estado anterior, esto basta para reconstruir
+    // el camino ocupando solo 2 bytes por estado, el 0 marca el estado inicial
+    vector<unsigned short> parent_move;
+    // Estado final encontrado, a partir de el reconstruimos el camino siguiendo la tabla de padres
+    StateType goal;
+    // Numero de estados que se han sacado de la cola para generar sus movimientos
+    long long states_expanded;
+    SearchStatus status;
+
+    PuzzleSearch() {}
+
+    // Las reglas que no tienen constructor sin parámetros se pasan al crear la búsqueda, después se empieza con restart()
+    explicit PuzzleSearch(const Rules &rules_) : rules(rules_) {}
+
+    // Prepara la búsqueda de un problema desde su estado inicial
+    void start(const Rules &rules_)
+    {
+        rules = rules_;
+        restart(rules.initial_state());
+    }
+
+    // Prepara la búsqueda con las reglas que ya tiene, a partir de initial_s
+    void restart(const StateType &initial_s)
+    {
+        frontier.clear();
+        head = 0;
+        visited.reset(rules.state_count());
+        parent_move.assign(rules.state_count(), 0);
+        states_expanded = 0;
+        status = SEARCH_RUNNING;
+
+        if (!rules.is_legal(initial_s))
+        {
+            status = SEARCH_EXHAUSTED;
+            return;
+        }
+        visited.test_and_set(rules.index(initial_s));
+        frontier.push_back(initial_s);
+        if (rules.is_goal(initial_s))
+        {
+            goal = initial_s;
+            status = SEARCH_FOUND;
+        }
+    }
+
+    // Avanza la búsqueda expandiendo como máximo max_expansions estados y devuelve como quedo la búsqueda
+    SearchStatus step(long long max_expansions)
+    {
+        long long expanded = 0;
+        size_t move_count = rules.move_count();
+
+        while (status == SEARCH_RUNNING && expanded < max_expansions)
+        {
+            // Si la cola se vacía entonces ya no hay estados alcanzables por explorar
+            if (head == frontier.size())
+            {
+                status = SEARCH_EXHAUSTED;
+                break;
+            }
+
+            // Sacamos el siguiente estado de la cola (copia, ya que frontier puede crecer dentro del ciclo)
+            StateType current_s = frontier[head++];
+            states_expanded++;
+            expanded++;
+
+            // Probamos todos los movimientos de la tabla, solo nos interesan estados validos que aun no se han descubierto
+            for (size_t i = 0; i < move_count; ++i)
+            {
+                StateType next_s;
+                if (!rules.apply(current_s, i, next_s))
+                    continue;
+                size_t next_index = rules.index(next_s);
+                if (visited.test_and_set(next_index))
+                    continue;
+
+                parent_move[next_index] = (unsigned short)(i + 1);
+
+                // Revisamos la solución al descubrir el estado, al ser BFS este ya es el camino mas corto
+                if (rules.is_goal(next_s))
+                {
+                    goal = next_s;
+                    status = SEARCH_FOUND;
+                    break;
+                }
+
+                frontier.push_back(next_s);
+            }
+        }
+
+        return status;
+    }
+
+    // Reconstruye el camino desde el estado inicial hasta la solución siguiendo la tabla de padres
+    void build_path(vector<StateType> &path) const
+    {
+        // Recorremos del final hacia el inicio, por lo que agregamos al final del vector y después lo volteamos
+        size_t first = path.size();
+        StateType s = goal;
+        while (true)
+        {
+            path.push_back(s);
+            unsigned short move = parent_move[rules.index(s)];
+            if (move == 0)
+                break;
+            // Hacemos el mismo movimiento de vuelta para obtener el estado anterior
+            StateType prev_s = s;
+            rules.apply(s, move - 1, prev_s);
+            s = prev_s;
+        }
+        reverse(path.begin() + first, path.end());
+    }
+
+    // Memoria reservada por la búsqueda en bytes, como los vectores nunca se encogen es el máximo que llego a ocupar
+    size_t memory_bytes() const
+    {
+        return visited.memory_bytes() + frontier.capacity() * sizeof(StateType) + parent_move.capacity() * sizeof(unsigned short) +
+               rules.memory_bytes();
+    }
+};
+
+// Las reglas del problema de misioneros y caníbales sobre State, is_valid y apply_move. Con BoatSafe en true dentro del bote
+// tampoco pueden ser mas los caníbales que los misioneros (las reglas de la simulación), con BoatSafe en false solo se revisan
+// las orillas, como en el enunciado original del problema
+template <bool BoatSafe>
+struct MissionaryRules
+{
+    typedef State StateType;
+
+    int total_m, total_c;
+    // Grupos que pueden viajar en el bote
+    vector<BoatLoad> moves;
+    // Solo se usa para calcular la posición de cada estado, sin sus bits
+    VisitedTable table;
+
+    MissionaryRules() : total_m(0), total_c(0) {}
+
+    MissionaryRules(int m, int c, int boat_capacity)
+    {
+        reset(m, c, boat_capacity);
+    }
+
+    void reset(int m, int c, int boat_capacity)
+    {
+        total_m = m;
+        total_c = c;
+        moves = build_move_table(boat_capacity, BoatSafe);
+        table.reset_index(total_m, total_c);
+    }
+
+    State initial_state() const
+    {
+        return State::make(total_m, total_c, 0);
+    }
+
+    bool is_legal(const State &s) const
+    {
+        return is_valid(s, total_m, total_c);
+    }
+
+    bool is_goal(const State &s) const
+    {
+        return is_solution(s, total_m, total_c);
+    }
+
+    size_t move_count() const
+    {
+        return moves.size();
+    }
+
+    bool apply(const State &s, size_t i, State &next_s) const
+    {
+        return apply_move(s, moves[i].m, moves[i].c, total_m, total_c, next_s) && is_valid(next_s, total_m, total_c);
+    }
+
+    size_t state_count() const
+    {
+        return table.size();
+    }
+
+    size_t index(const State &s) const
+    {
+        return table.index(s);
+    }
+
+    size_t memory_bytes() const
+    {
+        return moves.capacity() * sizeof(BoatLoad) + table.memory_bytes();
+    }
+
+    void describe(const State &s, char *line, size_t size) const
+    {
+        StateView v = s.view(total_m, total_c);
+        snprintf(line, size, "Left(M:%d, C:%d) Right(M:%d, C:%d) Boat:%s", v.m_left, v.c_left, v.m_right, v.c_right,
+                 v.boat_pos == 0 ? "Left" : "Right");
+    }
+};
+
+// Las reglas de la simulación, con el bote seguro
+typedef MissionaryRules<true> ClassicRules;
+
+// El BFS del problema clásico es el motor genérico con ClassicRules, solo agrega la misma forma de empezar que los demás motores
+struct BfsSearch : PuzzleSearch<ClassicRules>
+{
+    // Prepara la búsqueda a partir del estado inicial
+    void start(const State &initial_s, int m, int c, int boat_capacity)
+    {
+        rules.reset(m, c, boat_capacity);
+        restart(initial_s);
+    }
+};
+
+// Un lado de la búsqueda bidireccional, es un BFS por niveles que avanza desde su estado origen (el inicial o la solución)
+struct SearchSide
+{
+    // Cola de estados por expandir y el indice donde termina el nivel que se esta expandiendo
+    vector<State> frontier;
+    size_t head, level_end;
+    // Estados descubiertos por este lado
+    VisitedTable visited;
+    // Igual que en BfsSearch, el movimiento con el que se llego a cada estado (su indice mas 1), 0 para el origen
+    vector<unsigned short> parent_move;
+
+    void start(const State &origin, int m, int c)
+    {
+        frontier.clear();
+        visited.reset(m, c);
+        parent_move.assign(visited.size(), 0);
+        visited.set(visited.index(origin));
+        frontier.push_back(origin);
+        head = 0;
+        level_end = frontier.size();
+    }
+
+    // Estados que faltan por expandir en el nivel actual
+    size_t level_remaining() const
+    {
+        return level_end - head;
+    }
+
+    // Estados en la cola que aun no se expanden, al terminar un nivel es el tamaño del siguiente
+    size_t pending() const
+    {
+        return frontier.size() - head;
+    }
+
+    size_t memory_bytes() const
+    {
+        return visited.memory_bytes() + frontier.capacity() * sizeof(State) + parent_move.capacity() * sizeof(unsigned short);
+    }
+};
+
+// Motor de búsqueda bidireccional: un BFS avanza desde el estado inicial y otro hacia atrás desde la solución (todos a la
+// derecha), como regresar el mismo grupo en el bote deshace cualquier movimiento, los vecinos de un estado son los mismos en
+// ambas direcciones y el lado de la solución usa la misma tabla de movimientos. Cada vez se expande un nivel completo del lado
+// con la frontera mas chica, y la búsqueda termina cuando un lado descubre un estado que el otro ya tenia, el camino se une en
+// ese estado. Cada lado solo tiene que llegar a la mitad del camino, por lo que en problemas grandes se expanden muchos menos
+// estados que con BfsSearch, y el camino sigue siendo el mas corto
+struct BidirectionalSearch
+{
+    int total_m, total_c;
+    vector<BoatLoad> moves;
+    // Lado 0 desde el estado inicial, lado 1 desde la solución
+    SearchSide sides[2];
+    // Lado del que se esta expandiendo el nivel actual
+    int active;
+    // Estado donde se encontraron ambas búsquedas
+    State meet;
+    long long states_expanded;
+    SearchStatus status;
+
+    void start(const State &initial_s, int m, int c, int boat_capacity)
+    {
+        total_m = m;
+        total_c = c;
+        moves = build_move_table(boat_capacity);
+        states_expanded = 0;
+        status = SEARCH_RUNNING;
+        active = 0;
+
+        State goal_s = State::make(0, 0, 1);
+        sides[0].start(initial_s, total_m, total_c);
+        sides[1].start(goal_s, total_m, total_c);
+
+        if (initial_s == goal_s)
+        {
+            meet = initial_s;
+            status = SEARCH_FOUND;
+        }
+    }
+
+    // Avanza la búsqueda expandiendo como máximo max_expansions estados y devuelve como quedo la búsqueda
+    SearchStatus step(long long max_expansions)
+    {
+        long long expanded = 0;
+
+        while (status == SEARCH_RUNNING && expanded < max_expansions)
+        {
+            SearchSide &side = sides[active];
+
+            // Al terminar un nivel, el siguiente nivel de ese lado es todo lo que se agrego a su cola
+            if (side.level_remaining() == 0)
+            {
+                side.level_end = side.frontier.size();
+                // Si un lado ya no tiene estados por expandir, todo lo que alcanza ya se exploro sin tocar al otro lado
+                if (side.level_remaining() == 0)
+                {
+                    status = SEARCH_EXHAUSTED;
+                    break;
+                }
+                // Expandimos el lado con menos estados en su siguiente nivel, asi ambas fronteras crecen parejo (el otro
+                // lado siempre esta entre 2 niveles, ya que solo se cambia de lado al terminar uno)
+                if (sides[1 - active].pending() < side.pending())
+                {
+                    active = 1 - active;
+                    continue;
+                }
+            }
+
+            SearchSide &other = sides[1 - active];
+            State current_s = side.frontier[side.head++];
+            states_expanded++;
+            expanded++;
+
+            for (size_t i = 0; i < moves.size(); ++i)
+            {
+                State next_s;
+                if (!apply_move(current_s, moves[i].m, moves[i].c, total_m, total_c, next_s))
+                    continue;
+                if (!is_valid(next_s, total_m, total_c))
+                    continue;
+                size_t next_index = side.visited.index(next_s);
+                if (side.visited.test_and_set(next_index))
+                    continue;
+
+                side.parent_move[next_index] = (unsigned short)(i + 1);
+
+                // Las 2 tablas de visitados tienen la misma forma, por lo que el indice sirve para ambas
+                if (other.visited.test(next_index))
+                {
+                    meet = next_s;
+                    status = SEARCH_FOUND;
+                    break;
+                }
+
+                side.frontier.push_back(next_s);
+            }
+        }
+
+        return status;
+    }
+
+    // Agrega al vector path los estados desde s hasta el origen de un lado siguiendo su tabla de padres
+    void trace_to_origin(const SearchSide &side, State s, vector<State> &path) const
+    {
+        while (true)
+        {
+            path.push_back(s);
+            unsigned short move = side.parent_move[side.visited.index(s)];
+            if (move == 0)
+                break;
+            State prev_s = s;
+            const BoatLoad &load = moves[move - 1];
+            apply_move(s, load.m, load.c, total_m, total_c, prev_s);
+            s = prev_s;
+        }
+    }
+
+    // Reconstruye el camino: del estado inicial al punto de encuentro (volteado) y de ahí a la solución
+    void build_path(vector<State> &path) const
+    {
+        size_t first = path.size();
+        trace_to_origin(sides[0], meet, path);
+        reverse(path.begin() + first, path.end());
+        // El punto de encuentro ya esta en el camino, continuamos desde el siguiente estado hacia la solución
+        size_t meet_pos = path.size() - 1;
+        trace_to_origin(sides[1], meet, path);
+        path.erase(path.begin() + meet_pos);
+    }
+
+    size_t memory_bytes() const
+    {
+        return sides[0].memory_bytes() + sides[1].memory_bytes() + moves.capacity() * sizeof(BoatLoad);
+    }
+};
+
+// Cota inferior del numero de viajes que faltan para pasar a la derecha a las people personas que hay en la izquierda, con el
+// bote en la izquierda. Cada viaje de ida lleva a lo mucho boat_capacity personas y cada regreso trae al menos una, por lo que
+// con f idas y f - 1 regresos se pasan a lo mucho f * boat_capacity - (f - 1) personas, de ahí f = ceil((people - 1) / (k - 1))
+// idas y 2f - 1 viajes en total
+inline int left_crossings_lower_bound(long long people, int boat_capacity)
+{
+    if (people == 0)
+        return 0;
+    // Con capacidad 1 solo se resuelve con una persona, pero la cota debe de ser finita (se toma como si cupieran 2)
+    long long net_per_trip = max(1, boat_capacity - 1);
+    long long trips = max(1LL, (people - 1 + net_per_trip - 1) / net_per_trip);
+    return (int)(2 * trips - 1);
+}
+
+// Heurística de A*: cota inferior de los movimientos que faltan desde s hasta la solución. Si el bote esta en la derecha y aun
+// quedan personas en la izquierda, primero tiene que regresar trayendo al menos a una persona. Es consistente (un movimiento
+// la cambia en a lo mucho 1, ya que la cota solo sube 2 por cada boat_capacity - 1 personas), por lo que A* nunca tiene que
+// volver a abrir un estado ya expandido y el primer camino que saca de la cola hacia la solución es el mas corto
+inline int crossings_lower_bound(const State &s, int boat_capacity)
+{
+    long long people = (long long)s.m_left() + s.c_left();
+    if (people == 0)
+        return 0;
+    if (s.boat_pos() == 0)
+        return left_crossings_lower_bound(people, boat_capacity);
+    return 1 + left_crossings_lower_bound(people + 1, boat_capacity);
+}
+
+// Numero de cubetas de la cola de A*, f = g + h de un sucesor es a lo mucho 2 mas que el del estado expandido (g sube 1 y h sube
+// a lo mucho 1), asi que basta con un anillo de 4 cubetas indexado por f
+const int ASTAR_BUCKETS = 4;
+
+// Motor de búsqueda A*, expande primero los estados con menor f = g + h, donde g son los movimientos desde el inicio y h la
+// cota crossings_lower_bound, a diferencia del BFS no recorre todos los estados mas cercanos que la solución, solo los que
+// todavía pueden estar en un camino mas corto. Como f son enteros chicos, la cola de prioridad es una cola de cubetas (un vector
+// por cada valor de f) en lugar de un heap, meter y sacar es un push_back y un pop_back, y dentro de una cubeta se saca primero
+// lo ultimo que entro, que suele ser lo mas profundo, lo que rompe los empates a favor de acercarse a la solución
+struct AStarSearch
+{
+    int total_m, total_c, boat_capacity;
+    vector<BoatLoad> moves;
+    // Anillo de cubetas, la cubeta de f es buckets[f % ASTAR_BUCKETS]
+    vector<State> buckets[ASTAR_BUCKETS];
+    // Valor de f de la cubeta que se esta vaciando y cuantos estados hay en todas las cubetas
+    long long current_f;
+    size_t open_count;
+    // Estados ya expandidos (cerrados) y estados ya alcanzados
+    VisitedTable closed, reached;
+    // Menor numero de movimientos con el que se ha llegado a cada estado, solo es valido si el estado esta en reached, asi al
+    // empezar otra búsqueda basta con limpiar los bits de reached (1 bit por estado) y no hay que volver a llenar esta tabla
+    // (4 bytes por estado), lo que importa cuando se hacen muchas búsquedas seguidas como en la vista previa del menu
+    vector<uint32_t> best_g;
+    // Igual que en BfsSearch, el movimiento con el que se llego a cada estado por su mejor camino (valido para los alcanzados)
+    vector<unsigned short> parent_move;
+    State goal;
+    long long states_expanded;
+    SearchStatus status;
+
+    void start(const State &initial_s, int m, int c, int capacity)
+    {
+        total_m = m;
+        total_c = c;
+        boat_capacity = capacity;
+        moves = build_move_table(boat_capacity);
+        for (int i = 0; i < ASTAR_BUCKETS; ++i)
+            buckets[i].clear();
+        open_count = 0;
+        closed.reset(total_m, total_c);
+        reached.reset(total_m, total_c);
+        // resize solo llena la memoria nueva, lo que ya tenia la tabla se queda como estaba
+        best_g.resize(closed.size());
+        parent_move.resize(closed.size());
+        states_expanded = 0;
+        status = SEARCH_RUNNING;
+
+        size_t initial_index = closed.index(initial_s);
+        reached.set(initial_index);
+        best_g[initial_index] = 0;
+        parent_move[initial_index] = 0;
+        current_f = crossings_lower_bound(initial_s, boat_capacity);
+        push(initial_s, current_f);
+    }
+
+    void push(const State &s, long long f)
+    {
+        buckets[f % ASTAR_BUCKETS].push_back(s);
+        open_count++;
+    }
+
+    SearchStatus step(long long max_expansions)
+    {
+        long long expanded = 0;
+
+        while (status == SEARCH_RUNNING && expanded < max_expansions)
+        {
+            if (open_count == 0)
+            {
+                status = SEARCH_EXHAUSTED;
+                break;
+            }
+
+            // Si la cubeta de f ya se vació pasamos a la siguiente, f nunca baja porque la heurística es consistente
+            vector<State> &bucket = buckets[current_f % ASTAR_BUCKETS];
+            if (bucket.empty())
+            {
+                current_f++;
+                continue;
+            }
+
+            State current_s = bucket.back();
+            bucket.pop_back();
+            open_count--;
+
+            // Un estado puede estar varias veces en la cola si se encontró un camino mejor después de meterlo, solo se expande
+            // la primera vez que sale (con su mejor g)
+            size_t current_index = closed.index(current_s);
+            if (closed.test_and_set(current_index))
+                continue;
+            states_expanded++;
+            expanded++;
+
+            // Se revisa la solución al sacarla de la cola y no al descubrirla, ya que hasta entonces no se sabe si su g es el menor
+            if (is_solution(current_s, total_m, total_c))
+            {
+                goal = current_s;
+                status = SEARCH_FOUND;
+                break;
+            }
+
+            uint32_t next_g = best_g[current_index] + 1;
+            for (size_t i = 0; i < moves.size(); ++i)
+            {
+                State next_s;
+                if (!apply_move(current_s, moves[i].m, moves[i].c, total_m, total_c, next_s))
+                    continue;
+                if (!is_valid(next_s, total_m, total_c))
+                    continue;
+                size_t next_index = closed.index(next_s);
+                if (reached.test_and_set(next_index) && next_g >= best_g[next_index])
+                    continue;
+
+                best_g[next_index] = next_g;
+                parent_move[next_index] = (unsigned short)(i + 1);
+                push(next_s, next_g + crossings_lower_bound(next_s, boat_capacity));
+            }
+        }
+
+        return status;
+    }
+
+    // Reconstruye el camino desde la solución siguiendo la tabla de padres, igual que BfsSearch
+    void build_path(vector<State> &path) const
+    {
+        size_t first = path.size();
+        State s = goal;
+        while (true)
+        {
+            path.push_back(s);
+            unsigned short move = parent_move[closed.index(s)];
+            if (move == 0)
+                break;
+            State prev_s = s;
+            const BoatLoad &load = moves[move - 1];
+            apply_move(s, load.m, load.c, total_m, total_c, prev_s);
+            s = prev_s;
+        }
+        reverse(path.begin() + first, path.end());
+    }
+
+    size_t memory_bytes() const
+    {
+        size_t bytes = closed.memory_bytes() + reached.memory_bytes() + best_g.capacity() * sizeof(uint32_t) + parent_move.capacity() * sizeof(unsigned short) +
+                       moves.capacity() * sizeof(BoatLoad);
+        for (int i = 0; i < ASTAR_BUCKETS; ++i)
+            bytes += buckets[i].capacity() * sizeof(State);
+        return bytes;
+    }
+};
+
+// Algoritmos disponibles para resolver el problema
+enum SolverAlgorithm
+{
+    ALGORITHM_DFS,           // Búsqueda en profundidad, encuentra un camino cualquiera
+    ALGORITHM_BFS,           // Búsqueda en anchura, encuentra el camino con menos movimientos
+    ALGORITHM_BIDIRECTIONAL, // Búsqueda en anchura desde ambos extremos, el camino mas corto explorando menos estados
+    ALGORITHM_ASTAR,         // A* con una cota de los viajes que faltan, el camino mas corto en dirección a la solución
+    ALGORITHM_COUNT          // Numero de algoritmos, para recorrerlos
+};
+
+// Nombre corto del algoritmo para mostrarlo en pantalla
+inline const char *algorithm_name(SolverAlgorithm algorithm)
+{
+    if (algorithm == ALGORITHM_BIDIRECTIONAL)
+        return "BIDI";
+    if (algorithm == ALGORITHM_ASTAR)
+        return "A*";
+    return algorithm == ALGORITHM_BFS ? "BFS" : "DFS";
+}
+
+// Nombre del algoritmo en minúsculas, el mismo que acepta parse_algorithm, para usarlo en archivos y en la linea de comandos
+inline const char *algorithm_id(SolverAlgorithm algorithm)
+{
+    static const char *const ids[ALGORITHM_COUNT] = {"dfs", "bfs", "bidi", "astar"};
+    return ids[algorithm];
+}
+
+// Convierte el nombre de un algoritmo ("dfs", "bfs", "bidi" o "astar", sin importar mayúsculas) a su valor, devuelve false si no se reconoce
+inline bool parse_algorithm(const string &name, SolverAlgorithm &algorithm)
+{
+    string lower = name;
+    for (size_t i = 0; i < lower.size(); ++i)
+        lower[i] = (char)tolower((unsigned char)lower[i]);
+
+    if (lower == "dfs")
+        algorithm = ALGORITHM_DFS;
+    else if (lower == "bfs")
+        algorithm = ALGORITHM_BFS;
+    else if (lower == "bidi" || lower == "bidirectional")
+        algorithm = ALGORITHM_BIDIRECTIONAL;
+    else if (lower == "astar" || lower == "a*")
+        algorithm = ALGORITHM_ASTAR;
+    else
+        return false;
+    return true;
+}
+
+// Estadísticas de la ultima resolución, para poder comparar el costo de cada algoritmo
+struct SolveStats
+{
+    // Numero de estados que el algoritmo expandió antes de terminar
+    long long states_expanded;
+    // Memoria máxima en bytes de la tabla de visitados y de toda la búsqueda (visitados, pila o cola, tabla de padres)
+    size_t visited_bytes;
+    size_t search_bytes;
+};
+
+// Controles para una resolución que corre en otro hilo, el hilo que resuelve publica aquí cuantos estados lleva explorados y
+// revisa periódicamente si le pidieron cancelar, ambos campos son atómicos para que los pueda leer y escribir el otro hilo
+// sin bloquearse
+struct SolveControl
+{
+    // Si se pone en true la búsqueda se detiene lo antes posible y solve_mc devuelve false
+    atomic<bool> cancel;
+    // Estados explorados hasta el momento
+    atomic<long long> states_explored;
+
+    SolveControl() : cancel(false), states_explored(0) {}
+};
+
+// Cuantos estados se exploran entre cada revisión de los controles, es lo bastante grande para que revisar no cueste nada
+// y lo bastante chico para que cancelar se sienta inmediato
+const long long SEARCH_STEP_SIZE = 1 << 14;
+
+// Avanza una búsqueda (DfsSearch, BfsSearch, BidirectionalSearch o AStarSearch) hasta que termine, publicando el progreso y deteniéndose si se pide cancelar
+template <class Search>
+SearchStatus run_search(Search &search, SolveControl *control)
+{
+    while (search.step(SEARCH_STEP_SIZE) == SEARCH_RUNNING)
+    {
+        if (control)
+        {
+            control->states_explored.store(search.states_expanded);
+            if (control->cancel.load())
+                break;
+        }
+    }
+    if (control)
+        control->states_explored.store(search.states_expanded);
+    return search.status;
+}
+
+// Buffers de búsqueda que se pueden reutilizar entre varias resoluciones, cada motor conserva la memoria de su tabla de
+// visitados, su cola o pila y su tabla de padres, por lo que al resolver muchos problemas seguidos (por ejemplo en el modo
+// por lotes) no se vuelve a pedir memoria al sistema en cada uno
+struct SolverWorkspace
+{
+    DfsSearch dfs;
+    BfsSearch bfs;
+    BidirectionalSearch bidirectional;
+    AStarSearch astar;
+};
+
+// Memoria de las tablas de visitados de un motor de búsqueda (la bidireccional tiene una por cada lado y A* tiene la de cerrados)
+template <class Search>
+size_t search_visited_bytes(const Search &search)
+{
+    return search.visited.memory_bytes();
+}
+
+// El BFS guarda los bits aparte de la tabla de filas, que esta en sus reglas
+inline size_t search_visited_bytes(const BfsSearch &search)
+{
+    return search.visited.memory_bytes() + search.rules.table.memory_bytes();
+}
+
+inline size_t search_visited_bytes(const BidirectionalSearch &search)
+{
+    return search.sides[0].visited.memory_bytes() + search.sides[1].visited.memory_bytes();
+}
+
+inline size_t search_visited_bytes(const AStarSearch &search)
+{
+    return search.closed.memory_bytes();
+}
+
+// Resuelve el problema con un motor de búsqueda ya elegido, llenando las estadísticas y el camino si se encontró solución
+template <class Search>
+bool run_solve(Search &search, const State &initial_state, int initial_m, int initial_c, int boat_capacity, vector<State> &path,
+               SolveStats *stats, SolveControl *control)
+{
+    search.start(initial_state, initial_m, initial_c, boat_capacity);
+    SearchStatus status = run_search(search, control);
+
+    if (stats)
+    {
+        stats->states_expanded = search.states_expanded;
+        stats->visited_bytes = search_visited_bytes(search);
+        stats->search_bytes = search.memory_bytes();
+    }
+    if (status != SEARCH_FOUND)
+        return false;
+
+    search.build_path(path);
+    return true;
+}
+
+// Responde en tiempo constante si el problema tiene solución, sin buscar. La regla se obtuvo comparando contra la búsqueda
+// completa (BFS) para todos los problemas con hasta 60 misioneros, 60 caníbales y capacidad 12, y se explica asi:
+// - Sin personas no hay movimientos posibles, y si en la orilla izquierda hay mas caníbales que misioneros (con al menos un
+//   misionero) el estado inicial ya no es valido
+// - Con capacidad 1 cada viaje de ida necesita un viaje de regreso que trae a la misma persona, por lo que solo se puede
+//   resolver si hay una sola persona
+// - Con capacidad 2 o mas, si hay menos caníbales que misioneros (o no hay misioneros) siempre se puede, los misioneros
+//   sobrantes permiten cruzar de uno en uno sin quedar en desventaja en ninguna orilla
+// - Con el mismo numero de misioneros que de caníbales, con capacidad 2 solo se puede hasta 3 de cada uno (el problema
+//   clásico), con capacidad 3 hasta 5, y con capacidad 4 o mas siempre se puede
+// Esto solo aplica a las reglas de este solucionador (incluyendo que en el bote los misioneros tampoco pueden ser menos)
+inline bool is_solvable(int initial_m, int initial_c, int boat_capacity)
+{
+    if (initial_m + initial_c == 0 || (initial_m > 0 && initial_c > initial_m) || boat_capacity < 1)
+        return false;
+    if (boat_capacity == 1)
+        return initial_m + initial_c == 1;
+    if (initial_m == 0 || initial_c < initial_m)
+        return true;
+    // Mismo numero de misioneros y caníbales
+    if (boat_capacity == 2)
+        return initial_m <= 3;
+    if (boat_capacity == 3)
+        return initial_m <= 5;
+    return true;
+}
+
+// Resuelve el problema desde initial_state con el motor del algoritmo elegido, avanzando la búsqueda hasta que termine ya sea
+// encontrando la solución o agotando todos los estados. No revisa antes si el problema es valido o si tiene solución, eso lo
+// hace solve_mc (el benchmark la llama directamente para medir la búsqueda completa de los problemas sin solución)
+inline bool run_algorithm(SolverWorkspace &workspace, SolverAlgorithm algorithm, const State &initial_state, int initial_m, int initial_c,
+                          int boat_capacity, vector<State> &path, SolveStats *stats, SolveControl *control)
+{
+    if (algorithm == ALGORITHM_BFS)
+        return run_solve(workspace.bfs, initial_state, initial_m, initial_c, boat_capacity, path, stats, control);
+    if (algorithm == ALGORITHM_BIDIRECTIONAL)
+        return run_solve(workspace.bidirectional, initial_state, initial_m, initial_c, boat_capacity, path, stats, control);
+    if (algorithm == ALGORITHM_ASTAR)
+        return run_solve(workspace.astar, initial_state, initial_m, initial_c, boat_capacity, path, stats, control);
+    return run_solve(workspace.dfs, initial_state, initial_m, initial_c, boat_capacity, path, stats, control);
+}
+
+// Esta es la función principal la cual se va a encargar de solucionar el problema (si es que hay solución de este), si se
+// da un workspace se usan sus buffers, si no, se usan unos temporales, y si se da un control se puede seguir el progreso y
+// cancelar desde otro hilo
+inline bool solve_mc(int initial_m, int initial_c, int boat_capacity, vector<State> &path, SolverAlgorithm algorithm = ALGORITHM_DFS,
+                     SolveStats *stats = nullptr, SolverWorkspace *workspace = nullptr, SolveControl *control = nullptr)
+{
+    // Creamos una estructura inicial con el numero de misioneros y caníbales a trabajar (todos del lado izquierdo) y aparte
+    // la posición del bote que esta del lado izquierdo
+    State initial_state = State::make(initial_m, initial_c, 0);
+
+    if (stats)
+    {
+        stats->states_expanded = 0;
+        stats->visited_bytes = 0;
+        stats->search_bytes = 0;
+    }
+
+    // Antes de empezar a resolverlo, debemos de verificar si el problema se puede resolver con estos datos, para este momento,
+    // simplemente se hace para ver si los misioneros pierden en numero contra los caníbales (lo cual no es un estado inicial
+    // valido)
+    if (!is_valid(initial_state, initial_m, initial_c))
+        // De ser asi entonces ni siquiera podemos resolver el problema
+        return false;
+    // Si ya sabemos que no tiene solución no tiene caso buscar, sin esto la búsqueda tendría que recorrer todos los estados
+    // alcanzables antes de rendirse
+    if (!is_solvable(initial_m, initial_c, boat_capacity))
+        return false;
+
+    SolverWorkspace local_workspace;
+    if (!workspace)
+        workspace = &local_workspace;
+
+    // Si el problema es valido desde el inicio, entonces ya podemos resolver el problema con el algoritmo elegido
+    return run_algorithm(*workspace, algorithm, initial_state, initial_m, initial_c, boat_capacity, path, stats, control);
+}
+
+#endif